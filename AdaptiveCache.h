@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "ARCCache.h"
+#include "FifoCache.h"
+#include "KeyCodec.h"
+#include "LFUCache.h"
+#include "LRUCache.h"
+#include "MissRatioCurve.h"
+
+// 按采样影子缓存自动选择淘汰策略的缓存
+// 按键哈希采样约sample_rate的键(与ShardsEstimator相同的空间采样)，每个候选策略有一个容量为capacity * sample_rate的影子缓存，
+// 影子只保存键的哈希。每window次采样访问结算一次各影子的命中率，按指数加权平均得到得分；
+// 另一个策略的得分连续patience个窗口比当前策略高出margin以上时切换。切换本身不搬运条目：新策略的缓存立即接管，
+// 原缓存留作迁移源，之后每次get/put顺带按原策略的淘汰顺序(从最不重要到最重要)搬运migrate_batch个常驻条目，
+// 新缓存未命中时先到原缓存中查找并把命中的条目搬过来，写入和删除同时作用于原缓存中的旧值。
+// 因此读路径上不会出现一次重建整个缓存的停顿，搬完之前不会再次切换；迁移期间两个缓存合计的条目数可能暂时超过capacity。
+// 条目不因切换丢弃(ARC的幽灵历史和LFU的频率不迁移)。
+// 候选策略是模板参数为值类型的缓存模板，需要提供takeVictim，addPolicy可以加入新的策略。不是线程安全的。
+template<typename T>
+class AdaptiveCache {
+private:
+    // 当前使用的缓存，虚函数只在这一层，各策略的实现不变
+    class Live {
+    public:
+        virtual ~Live() {}
+        virtual bool get(std::string_view key, T& value) = 0;
+        virtual void put(std::string_view key, const T& value) = 0;
+        virtual bool erase(std::string_view key) = 0;
+        virtual size_t size() const = 0;
+        virtual bool take(std::string_view key, T& value) = 0;
+        virtual size_t moveInto(Live& target, size_t limit) = 0;
+    };
+
+    template<typename CacheType>
+    class LiveImpl : public Live {
+    private:
+        CacheType cache;
+
+    public:
+        explicit LiveImpl(size_t capacity) : cache(capacity) {}
+
+        bool get(std::string_view key, T& value) override {
+            return cache.get(key, value);
+        }
+
+        void put(std::string_view key, const T& value) override {
+            cache.put(key, value);
+        }
+
+        bool erase(std::string_view key) override {
+            return cache.erase(key);
+        }
+
+        size_t size() const override {
+            return cache.size();
+        }
+
+        // 取出一个条目
+        bool take(std::string_view key, T& value) override {
+            if (!cache.get(key, value)) {
+                return false;
+            }
+            cache.erase(key);
+            return true;
+        }
+
+        // 按原策略的淘汰顺序(从最不重要到最重要)搬运至多limit个条目，越重要的条目在新策略中越新，返回搬运的条目数
+        size_t moveInto(Live& target, size_t limit) override {
+            std::string key;
+            ValueHandle<T> value;
+            size_t moved = 0;
+            while (moved < limit && cache.takeVictim(key, value)) {
+                target.put(key, *value);
+                moved++;
+            }
+            return moved;
+        }
+    };
+
+    // 影子缓存只模拟命中：键是8字节的哈希，值为空
+    class Shadow {
+    public:
+        virtual ~Shadow() {}
+        virtual bool access(std::string_view key) = 0;
+        virtual void insert(std::string_view key) = 0;
+    };
+
+    template<typename CacheType>
+    class ShadowImpl : public Shadow {
+    private:
+        CacheType cache;
+
+    public:
+        explicit ShadowImpl(size_t capacity) : cache(capacity) {}
+
+        // 读取，未命中时按读穿透载入
+        bool access(std::string_view key) override {
+            uint8_t value;
+            if (cache.get(key, value)) {
+                return true;
+            }
+            cache.emplace(key, uint8_t(0));
+            return false;
+        }
+
+        // 写入：已存在时不算访问，避免读穿透的get + put被LFU计为两次
+        void insert(std::string_view key) override {
+            cache.emplace(key, uint8_t(0));
+        }
+    };
+
+    struct Candidate {
+        std::string name;
+        std::unique_ptr<Shadow> shadow;
+        std::unique_ptr<Live> (*make_live)(size_t);
+        size_t window_hits;
+        double score;  // 命中率的指数加权平均，-1表示还没有结算过
+    };
+
+    size_t capacity;
+    double sample_rate;
+    uint64_t threshold;
+    size_t shadow_capacity;
+    size_t window;
+    double margin;
+    int patience;
+    size_t migrate_batch;
+
+    std::vector<Candidate> candidates;
+    std::unique_ptr<Live> live;
+    std::unique_ptr<Live> draining;  // 切换前的缓存，剩余条目逐批搬到live，搬完后释放
+    size_t current;
+    size_t window_accesses;
+    size_t challenger;
+    int streak;
+    size_t switches;
+
+    template<typename CacheType>
+    static std::unique_ptr<Live> makeLive(size_t capacity) {
+        return std::unique_ptr<Live>(new LiveImpl<CacheType>(capacity));
+    }
+
+    // 返回采样键在影子缓存中的键(8字节哈希)，未被采样时返回false
+    bool sampled(std::string_view key, uint64_t& hash) const {
+        hash = KeyCodec::hashKey(key);
+        return hash < threshold;
+    }
+
+    void endWindow() {
+        size_t best = current;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            Candidate& c = candidates[i];
+            double rate = static_cast<double>(c.window_hits) / window;
+            c.score = c.score < 0 ? rate : 0.5 * c.score + 0.5 * rate;
+            c.window_hits = 0;
+            if (c.score > candidates[best].score) {
+                best = i;
+            }
+        }
+        window_accesses = 0;
+
+        if (draining || best == current || candidates[best].score < candidates[current].score + margin) {
+            streak = 0;
+            return;
+        }
+        streak = best == challenger ? streak + 1 : 1;
+        challenger = best;
+        if (streak >= patience) {
+            switchTo(best);
+        }
+    }
+
+    // 只换上新策略的空缓存，条目由migrate分批搬运
+    void switchTo(size_t index) {
+        draining = std::move(live);
+        live = candidates[index].make_live(capacity);
+        current = index;
+        streak = 0;
+        switches++;
+    }
+
+    // 搬运一批条目，原缓存搬空后释放
+    void migrate() {
+        if (draining && draining->moveInto(*live, migrate_batch) < migrate_batch) {
+            draining.reset();
+        }
+    }
+
+public:
+    // window是每次结算的采样访问数，margin是切换所需的命中率差(绝对值)，patience是连续领先的窗口数，
+    // batch是切换后每次操作搬运的条目数
+    explicit AdaptiveCache(size_t cap, double rate = 0.01, size_t win = 2000, double min_margin = 0.02,
+                           int windows = 2, size_t batch = 64)
+        : capacity(cap), window(win), margin(min_margin), patience(windows), migrate_batch(std::max<size_t>(batch, 1)),
+          current(0), window_accesses(0), challenger(0), streak(0), switches(0) {
+        // 影子太小时命中率估计不准，至少保留64个条目
+        sample_rate = cap ? std::min(1.0, std::max(rate, 64.0 / cap)) : 1.0;
+        threshold = sample_rate >= 1.0 ? UINT64_MAX : static_cast<uint64_t>(sample_rate * 18446744073709551616.0);
+        shadow_capacity = std::max<size_t>(static_cast<size_t>(cap * sample_rate + 0.5), 1);
+        addPolicy<LRUCache>("LRU");
+        addPolicy<FIFOCache>("FIFO");
+        addPolicy<LFUCache>("LFU");
+        addPolicy<ARCCache>("ARC");
+        live = candidates[0].make_live(capacity);
+    }
+
+    // 加入候选策略，CacheType<T>用作实际缓存，CacheType<uint8_t>用作影子
+    template<template<typename...> class CacheType>
+    void addPolicy(const std::string& name) {
+        candidates.push_back(Candidate{name, std::unique_ptr<Shadow>(new ShadowImpl<CacheType<uint8_t>>(shadow_capacity)),
+                                       &AdaptiveCache::makeLive<CacheType<T>>, 0, -1.0});
+    }
+
+    bool get(std::string_view key, T& value) {
+        uint64_t hash;
+        if (sampled(key, hash)) {
+            std::string_view shadow_key(reinterpret_cast<const char*>(&hash), sizeof(hash));
+            for (Candidate& c : candidates) {
+                c.window_hits += c.shadow->access(shadow_key);
+            }
+            if (++window_accesses >= window) {
+                endWindow();
+            }
+        }
+        migrate();
+        if (live->get(key, value)) {
+            return true;
+        }
+        // 还没有搬过来的条目
+        if (draining && draining->take(key, value)) {
+            live->put(key, value);
+            return true;
+        }
+        return false;
+    }
+
+    void put(std::string_view key, const T& value) {
+        uint64_t hash;
+        if (sampled(key, hash)) {
+            std::string_view shadow_key(reinterpret_cast<const char*>(&hash), sizeof(hash));
+            for (Candidate& c : candidates) {
+                c.shadow->insert(shadow_key);
+            }
+        }
+        migrate();
+        if (draining) {
+            draining->erase(key);
+        }
+        live->put(key, value);
+    }
+
+    bool erase(std::string_view key) {
+        bool erased = live->erase(key);
+        if (draining) {
+            erased = draining->erase(key) || erased;
+        }
+        return erased;
+    }
+
+    size_t size() const {
+        return live->size() + (draining ? draining->size() : 0);
+    }
+
+    // 是否还在从切换前的缓存搬运条目
+    bool migrating() const {
+        return draining != nullptr;
+    }
+
+    const std::string& policy() const {
+        return candidates[current].name;
+    }
+
+    size_t switchCount() const {
+        return switches;
+    }
+
+    double sampleRate() const {
+        return sample_rate;
+    }
+
+    // 各候选策略最近的命中率估计
+    std::vector<std::pair<std::string, double>> estimates() const {
+        std::vector<std::pair<std::string, double>> result;
+        for (const Candidate& c : candidates) {
+            result.emplace_back(c.name, c.score < 0 ? 0.0 : c.score);
+        }
+        return result;
+    }
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// 全局内存分配计数，用于统计各缓存实现每次操作的堆分配次数和实际占用的内存
+// 计数需要替换全局operator new/delete：每次分配多5次原子操作和16字节头部，会影响其他测试的耗时和内存占用，
+// 所以默认不替换，只在专门测量分配的构建中加上-DALLOC_COUNTER_ENABLED=1。关闭时计数恒为0，enabled()返回false。
+// 打开时只能在一个编译单元(main.cpp)中包含
+#ifndef ALLOC_COUNTER_ENABLED
+#define ALLOC_COUNTER_ENABLED 0
+#endif
+
+namespace AllocCounter {
+    inline constexpr bool enabled() {
+        return ALLOC_COUNTER_ENABLED != 0;
+    }
+
+    inline std::atomic<size_t>& allocations() {
+        static std::atomic<size_t> count(0);
+        return count;
+    }
+
+    inline std::atomic<size_t>& allocatedBytes() {
+        static std::atomic<size_t> bytes(0);
+        return bytes;
+    }
+
+    // 当前仍未释放的字节数
+    inline std::atomic<size_t>& liveBytes() {
+        static std::atomic<size_t> bytes(0);
+        return bytes;
+    }
+
+    // 当前仍未释放的内存块数
+    inline std::atomic<size_t>& liveBlocks() {
+        static std::atomic<size_t> blocks(0);
+        return blocks;
+    }
+
+    // 不计本文件附加的头部时，glibc malloc为一次申请实际占用的块大小：8字节块头，按16字节对齐，最小32字节
+    inline size_t chunkSize(size_t size) {
+        size_t chunk = (size + 8 + 15) & ~size_t(15);
+        return chunk < 32 ? 32 : chunk;
+    }
+
+    // 当前仍未释放的内存按malloc块大小计算的总字节数，包括分配器的块头和对齐浪费
+    inline std::atomic<size_t>& liveChunkBytes() {
+        static std::atomic<size_t> bytes(0);
+        return bytes;
+    }
+
+    // 每块内存前面保留16字节记录申请大小，释放时据此更新liveBytes，同时保持16字节对齐
+    const size_t kHeaderSize = 16;
+
+    // 记录一段代码执行期间发生的分配次数和字节数
+    class Scope {
+    private:
+        size_t start_allocations;
+        size_t start_bytes;
+
+    public:
+        Scope() : start_allocations(allocations().load()), start_bytes(allocatedBytes().load()) {}
+
+        size_t count() const {
+            return allocations().load() - start_allocations;
+        }
+
+        size_t bytes() const {
+            return allocatedBytes().load() - start_bytes;
+        }
+    };
+}
+
+#if ALLOC_COUNTER_ENABLED
+void* operator new(size_t size) {
+    AllocCounter::allocations().fetch_add(1, std::memory_order_relaxed);
+    AllocCounter::allocatedBytes().fetch_add(size, std::memory_order_relaxed);
+    AllocCounter::liveBytes().fetch_add(size, std::memory_order_relaxed);
+    AllocCounter::liveBlocks().fetch_add(1, std::memory_order_relaxed);
+    AllocCounter::liveChunkBytes().fetch_add(AllocCounter::chunkSize(size), std::memory_order_relaxed);
+    char* p = static_cast<char*>(std::malloc(size + AllocCounter::kHeaderSize));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t*>(p) = size;
+    return p + AllocCounter::kHeaderSize;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+// 不内联，否则GCC会把内联后的free与operator new误判为不匹配
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    if (!p) {
+        return;
+    }
+    char* block = static_cast<char*>(p) - AllocCounter::kHeaderSize;
+    size_t size = *reinterpret_cast<size_t*>(block);
+    AllocCounter::liveBytes().fetch_sub(size, std::memory_order_relaxed);
+    AllocCounter::liveBlocks().fetch_sub(1, std::memory_order_relaxed);
+    AllocCounter::liveChunkBytes().fetch_sub(AllocCounter::chunkSize(size), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    operator delete(p);
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// 缓存背后的数据源接口，MySQLDB和InMemoryStore都实现这个接口
+// 单个读写与批量读写；getDataBatch只返回找到的键。实现是否线程安全由具体类说明。
+class BackingStore {
+public:
+    virtual ~BackingStore() {}
+
+    virtual bool getData(const std::string& key, std::string& value) = 0;
+    virtual bool putData(const std::string& key, const std::string& value) = 0;
+    virtual bool getDataBatch(const std::vector<std::string>& keys,
+                              std::vector<std::pair<std::string, std::string>>& rows) = 0;
+    virtual bool putDataBatch(const std::vector<std::pair<std::string, std::string>>& rows) = 0;
+};
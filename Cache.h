@@ -0,0 +1,1378 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "CachePolicy.h"
+#include "CacheStats.h"
+#include "FlatHashMap.h"
+#include "TimingWheel.h"
+
+// 基于策略的缓存模板
+// Cache<Key, Value, Eviction, Hash, Alloc, Stats, Expiry, Lock, Weigher>：淘汰策略、哈希、键类型、节点分配器、权重函数，
+// 以及统计、过期、加锁三个可选功能都是模板参数，在编译时组合。关闭的功能是空类型，调用被内联为空操作，
+// 节点通过空基类优化不占空间。capacity是权重上限，默认UnitWeigher时就是条目数。
+// FIFOCache/LRUCache/LFUCache/ARCCache都是HandleCache(本文件末尾)对这个模板的适配，淘汰逻辑只在下面的策略中实现一份。
+//
+// 淘汰策略是一个带有Hook(嵌入节点的元数据)和Policy<Node>模板的类型，Policy需要提供：
+//   bool resident(const Node&)                         是否常驻(ARC的幽灵条目不常驻)
+//   void onHit(Node&)                                   常驻条目被读取
+//   void onInsert(Node&, Ops&)                          新键写入(节点权重已设置)，先通过ops淘汰其他条目腾出空间
+//   void onUpdate(Node&, size_t weight, Ops&)           常驻条目的值被替换，新权重为weight，超出容量时淘汰
+//   CacheCounter onGhostHit(Node&, size_t weight, Ops&) 写入一个幽灵条目，返回要记录的幽灵命中计数
+//   void onErase(Node&)                                 条目被删除或过期
+//   bool onRestore(Node&, bool has_value, uint32_t meta, Ops&)  按快照恢复一个条目，返回是否接受。只用空闲容量，
+//                                                       不淘汰现有条目，恢复的条目排在现有条目之前(先被淘汰)
+//   void forEach(Visitor)                               按恢复顺序访问所有节点，visit(node, meta)
+//   Node* victim()                                      下一个将被淘汰的常驻条目
+//   void forEachVictim(size_t weight, Visitor)          按淘汰顺序访问写入一个权重为weight的新键需要淘汰的常驻条目，
+//                                                       visit(node)返回false时停止
+//   size()、weight()、ghostSize()、state()、restoreState(uint64_t)、addGauges(CacheStatsSnapshot&)
+// Ops提供evict(node)(删除常驻条目)、demote(node)(常驻条目降为幽灵，释放值)、forget(node)(删除幽灵条目)，
+// 调用evict和forget之前策略要先把节点从自己的结构中取下。
+
+// 键的哈希。整数键用splitmix64的混合函数，不经过字符串哈希，低位也均匀(FlatHashMap用低7位作tag)；
+// 字符串键与FlatHash相同，可以用std::string_view查找
+template<typename Key, typename Enable = void>
+struct CacheHash : FlatHash<Key> {};
+
+template<typename Key>
+struct CacheHash<Key, typename std::enable_if<std::is_integral<Key>::value>::type> {
+    size_t operator()(Key key) const {
+        uint64_t x = static_cast<uint64_t>(key) + 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<size_t>(x ^ (x >> 31));
+    }
+};
+
+// 不统计：record为空函数
+struct NoStats {
+    void record(CacheCounter, uint64_t = 1) {}
+
+    CacheStatsSnapshot snapshot() const {
+        return CacheStatsSnapshot();
+    }
+};
+
+// 不过期：节点中的Stamp是空类型
+// 过期策略需要提供：tick(on_expire)每次操作开始时调用，advance(on_expire)立即回收所有到期条目，
+// stamp(写入时)、touch(命中时)、expired(命中前核对)、onExpire(条目因到期被删除)、release(节点释放或降为幽灵)
+struct NoExpiry {
+    struct Stamp {};
+
+    template<typename Callback>
+    void tick(Callback) {}
+
+    template<typename Callback>
+    void advance(Callback) {}
+
+    void stamp(Stamp&) {}
+
+    void touch(Stamp&) {}
+
+    bool expired(const Stamp&) const {
+        return false;
+    }
+
+    void onExpire(Stamp&) {}
+
+    void release(Stamp&) {}
+};
+
+// 写入后ttl过期，与ExpiringCache相同的做法：每次操作读一次粗粒度时钟(coarseClockMs，不调用steady_clock::now())，
+// 命中时核对节点的到期时间，已到期的按未命中处理并删除；节点同时是时间轮的定时器，
+// 每interval次操作推进一次时间轮，回收到期但没有再被读到的条目
+struct TtlExpiry {
+    struct Stamp : TimingWheel::Timer {};
+
+    uint64_t ttl_ms;
+    uint64_t start_ms;
+    uint64_t now_ms;
+    unsigned interval;
+    unsigned ops;
+    std::unique_ptr<TimingWheel> wheel;  // 时间轮不可移动，放在堆上使TtlExpiry可以按值传入Cache
+
+    explicit TtlExpiry(std::chrono::milliseconds ttl = std::chrono::seconds(60), unsigned clock_interval = 64)
+        : ttl_ms(ttl.count()), start_ms(coarseClockMs()), now_ms(0), interval(std::max(clock_interval, 1u)), ops(0),
+          wheel(new TimingWheel()) {}
+
+    // 每次操作开始时调用，到期的定时器交给on_expire(Stamp*)
+    template<typename Callback>
+    void tick(Callback on_expire) {
+        if (++ops >= interval) {
+            advance(on_expire);
+        } else {
+            now_ms = coarseClockMs() - start_ms;
+        }
+    }
+
+    template<typename Callback>
+    void advance(Callback on_expire) {
+        now_ms = coarseClockMs() - start_ms;
+        ops = 0;
+        wheel->advance(now_ms, [&on_expire](TimingWheel::Timer* timer) {
+            on_expire(static_cast<Stamp*>(timer));
+        });
+    }
+
+    void stamp(Stamp& s) {
+        wheel->schedule(&s, now_ms + ttl_ms);
+    }
+
+    void touch(Stamp&) {}
+
+    bool expired(const Stamp& s) const {
+        return now_ms >= s.deadline;
+    }
+
+    void onExpire(Stamp&) {}
+
+    void release(Stamp& s) {
+        wheel->cancel(&s);
+    }
+};
+
+// 不加锁。需要线程安全时把Lock换成std::mutex
+struct NoLock {
+    void lock() {}
+    void unlock() {}
+};
+
+// 节点中的权重。UnitWeigher时每个条目权重为1，不占空间，也不调用权重函数
+template<typename Weigher>
+struct EntryWeight {
+    size_t entry_weight = 1;
+
+    size_t weight() const {
+        return entry_weight;
+    }
+
+    void setWeight(size_t w) {
+        entry_weight = w;
+    }
+
+    template<typename Key, typename Value>
+    static size_t compute(Weigher& weigher, const Key& key, const Value& value) {
+        return weigher(key, value);
+    }
+};
+
+template<>
+struct EntryWeight<UnitWeigher> {
+    size_t weight() const {
+        return 1;
+    }
+
+    void setWeight(size_t) {}
+
+    template<typename Key, typename Value>
+    static size_t compute(UnitWeigher&, const Key&, const Value&) {
+        return 1;
+    }
+};
+
+// 侵入式双向链表，节点通过继承ListHook挂在链表上，插入删除不分配内存
+struct ListHook {
+    ListHook* prev;
+    ListHook* next;
+};
+
+class IntrusiveList {
+private:
+    ListHook head;  // 哨兵：head.next是表头(最老)，head.prev是表尾(最新)
+    ListHook* restored;  // 最后一个用pushRestored插入、仍在表中的节点，没有时为哨兵
+    size_t count;
+
+public:
+    IntrusiveList() : restored(&head), count(0) {
+        head.prev = head.next = &head;
+    }
+
+    // 哨兵的地址被节点引用，不允许拷贝和移动
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    void pushBack(ListHook* node) {
+        node->prev = head.prev;
+        node->next = &head;
+        head.prev->next = node;
+        head.prev = node;
+        count++;
+    }
+
+    // 插入到之前恢复的节点之后、其余节点之前：恢复的节点保持相互之间的顺序，整体排在pushBack的节点前面
+    void pushRestored(ListHook* node) {
+        node->prev = restored;
+        node->next = restored->next;
+        restored->next->prev = node;
+        restored->next = node;
+        restored = node;
+        count++;
+    }
+
+    void remove(ListHook* node) {
+        if (node == restored) {
+            restored = node->prev;
+        }
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        count--;
+    }
+
+    ListHook* front() const {
+        return head.next;
+    }
+
+    // 遍历的结束位置(哨兵)
+    const ListHook* end() const {
+        return &head;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // 从表头到表尾访问每个节点
+    template<typename Node, typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const ListHook* hook = head.next; hook != &head; hook = hook->next) {
+            visit(*static_cast<const Node*>(hook));
+        }
+    }
+};
+
+// 先进先出和最近最少使用共用的队列策略：淘汰表头，move_on_access为true时读取和更新移到表尾(LRU)
+template<typename Node, bool move_on_access>
+class QueuePolicy {
+private:
+    IntrusiveList order;
+    size_t capacity;
+    size_t total_weight;
+
+    template<typename Ops>
+    void evictFront(Ops& ops) {
+        Node& victim = *static_cast<Node*>(order.front());
+        onErase(victim);
+        ops.evict(victim);
+    }
+
+public:
+    explicit QueuePolicy(size_t cap) : capacity(cap), total_weight(0) {}
+
+    bool resident(const Node&) const {
+        return true;
+    }
+
+    void onHit(Node& node) {
+        if (move_on_access) {
+            order.remove(&node);
+            order.pushBack(&node);
+        }
+    }
+
+    template<typename Ops>
+    void onInsert(Node& node, Ops& ops) {
+        while (!order.empty() && total_weight + node.weight() > capacity) {
+            evictFront(ops);
+        }
+        order.pushBack(&node);
+        total_weight += node.weight();
+    }
+
+    // 值变大时从表头继续淘汰，至少保留这个条目
+    template<typename Ops>
+    void onUpdate(Node& node, size_t weight, Ops& ops) {
+        total_weight = total_weight - node.weight() + weight;
+        node.setWeight(weight);
+        onHit(node);
+        while (total_weight > capacity && order.size() > 1) {
+            evictFront(ops);
+        }
+    }
+
+    template<typename Ops>
+    CacheCounter onGhostHit(Node&, size_t, Ops&) {
+        return kHits;  // 没有幽灵条目，不会调用
+    }
+
+    void onErase(Node& node) {
+        order.remove(&node);
+        total_weight -= node.weight();
+    }
+
+    // 只放入空闲容量，排在重启后写入的条目之前
+    template<typename Ops>
+    bool onRestore(Node& node, bool has_value, uint32_t, Ops&) {
+        if (!has_value || total_weight + node.weight() > capacity) {
+            return false;
+        }
+        order.pushRestored(&node);
+        total_weight += node.weight();
+        return true;
+    }
+
+    // 从最老到最新，meta恒为0
+    template<typename Visitor>
+    void forEach(Visitor visit) const {
+        order.forEach<Node>([&visit](const Node& node) { visit(node, 0u); });
+    }
+
+    Node* victim() const {
+        return order.empty() ? nullptr : static_cast<Node*>(order.front());
+    }
+
+    // 与onInsert相同，从表头淘汰直到放得下
+    template<typename Visitor>
+    void forEachVictim(size_t weight, Visitor visit) const {
+        size_t total = total_weight;
+        for (const ListHook* hook = order.front(); hook != order.end() && total + weight > capacity;
+             hook = hook->next) {
+            const Node& node = *static_cast<const Node*>(hook);
+            total -= node.weight();
+            if (!visit(node)) {
+                return;
+            }
+        }
+    }
+
+    size_t size() const {
+        return order.size();
+    }
+
+    size_t weight() const {
+        return total_weight;
+    }
+
+    size_t ghostSize() const {
+        return 0;
+    }
+
+    uint64_t state() const {
+        return 0;
+    }
+
+    void restoreState(uint64_t) {}
+
+    void addGauges(CacheStatsSnapshot&) const {}
+};
+
+// 先进先出：读取和更新都不改变顺序
+struct FifoEviction {
+    struct Hook : ListHook {};
+
+    template<typename Node>
+    using Policy = QueuePolicy<Node, false>;
+};
+
+// 最近最少使用：读取和更新都移到表尾
+struct LruEviction {
+    struct Hook : ListHook {};
+
+    template<typename Node>
+    using Policy = QueuePolicy<Node, true>;
+};
+
+// 最不经常使用：每个频率一个桶，桶内按LRU排列；桶按频率从低到高串成链表，表头就是最低频率，
+// 淘汰取第一个桶的表头，空桶立即删除，读取、写入、删除和淘汰都是O(1)，不需要重新查找最低频率
+struct LfuEviction {
+    struct Bucket {
+        Bucket* prev;
+        Bucket* next;
+        uint32_t frequency;
+        IntrusiveList nodes;  // 表头最久未访问
+
+        explicit Bucket(uint32_t f) : prev(this), next(this), frequency(f) {}
+    };
+
+    struct Hook : ListHook {
+        Bucket* bucket;
+    };
+
+    template<typename Node>
+    class Policy {
+    private:
+        Bucket head;  // 哨兵，head.next是最低频率的桶
+        size_t count;
+        size_t capacity;
+        size_t total_weight;
+
+        // 返回紧跟在position之后、频率为freq的桶，不存在时新建
+        Bucket* bucketAfter(Bucket* position, uint32_t freq) {
+            if (position->next != &head && position->next->frequency == freq) {
+                return position->next;
+            }
+            Bucket* bucket = new Bucket(freq);
+            bucket->prev = position;
+            bucket->next = position->next;
+            position->next->prev = bucket;
+            position->next = bucket;
+            return bucket;
+        }
+
+        void releaseIfEmpty(Bucket* bucket) {
+            if (bucket->nodes.empty()) {
+                bucket->prev->next = bucket->next;
+                bucket->next->prev = bucket->prev;
+                delete bucket;
+            }
+        }
+
+        void moveTo(Node& node, Bucket* to) {
+            Bucket* from = node.bucket;
+            from->nodes.remove(&node);
+            to->nodes.pushBack(&node);
+            node.bucket = to;
+            releaseIfEmpty(from);
+        }
+
+        template<typename Ops>
+        void evictMin(Ops& ops) {
+            Node& victim = *static_cast<Node*>(head.next->nodes.front());
+            onErase(victim);
+            ops.evict(victim);
+        }
+
+    public:
+        explicit Policy(size_t cap) : head(0), count(0), capacity(cap), total_weight(0) {}
+
+        Policy(const Policy&) = delete;
+        Policy& operator=(const Policy&) = delete;
+
+        ~Policy() {
+            while (head.next != &head) {
+                Bucket* bucket = head.next;
+                head.next = bucket->next;
+                delete bucket;
+            }
+        }
+
+        bool resident(const Node&) const {
+            return true;
+        }
+
+        // 移到下一个频率的桶
+        void onHit(Node& node) {
+            moveTo(node, bucketAfter(node.bucket, node.bucket->frequency + 1));
+        }
+
+        template<typename Ops>
+        void onInsert(Node& node, Ops& ops) {
+            while (count > 0 && total_weight + node.weight() > capacity) {
+                evictMin(ops);
+            }
+            Bucket* ones = bucketAfter(&head, 1);
+            ones->nodes.pushBack(&node);
+            node.bucket = ones;
+            count++;
+            total_weight += node.weight();
+        }
+
+        template<typename Ops>
+        void onUpdate(Node& node, size_t weight, Ops& ops) {
+            total_weight = total_weight - node.weight() + weight;
+            node.setWeight(weight);
+            onHit(node);
+            while (total_weight > capacity && count > 1) {
+                evictMin(ops);
+            }
+        }
+
+        template<typename Ops>
+        CacheCounter onGhostHit(Node&, size_t, Ops&) {
+            return kHits;  // 没有幽灵条目，不会调用
+        }
+
+        void onErase(Node& node) {
+            Bucket* bucket = node.bucket;
+            bucket->nodes.remove(&node);
+            releaseIfEmpty(bucket);
+            count--;
+            total_weight -= node.weight();
+        }
+
+        // 只放入空闲容量，放到原来的频率桶中重启后访问过的条目之前。
+        // 按频率递增恢复时目标桶总在表尾附近，从表尾向前查找(哨兵的频率为0)
+        template<typename Ops>
+        bool onRestore(Node& node, bool has_value, uint32_t meta, Ops&) {
+            if (!has_value || total_weight + node.weight() > capacity) {
+                return false;
+            }
+            uint32_t freq = std::max<uint32_t>(meta, 1);
+            Bucket* position = head.prev;
+            while (position->frequency >= freq) {
+                position = position->prev;
+            }
+            Bucket* bucket = bucketAfter(position, freq);
+            bucket->nodes.pushRestored(&node);
+            node.bucket = bucket;
+            count++;
+            total_weight += node.weight();
+            return true;
+        }
+
+        // 按频率从低到高、同频率内从最久未访问到最近访问，meta为频率
+        template<typename Visitor>
+        void forEach(Visitor visit) const {
+            for (const Bucket* bucket = head.next; bucket != &head; bucket = bucket->next) {
+                uint32_t freq = bucket->frequency;
+                bucket->nodes.template forEach<Node>([&visit, freq](const Node& node) { visit(node, freq); });
+            }
+        }
+
+        Node* victim() const {
+            return head.next == &head ? nullptr : static_cast<Node*>(head.next->nodes.front());
+        }
+
+        // 与onInsert相同，从最低频率的桶开始、桶内从最久未访问开始淘汰直到放得下
+        template<typename Visitor>
+        void forEachVictim(size_t weight, Visitor visit) const {
+            size_t total = total_weight;
+            for (const Bucket* bucket = head.next; bucket != &head; bucket = bucket->next) {
+                const IntrusiveList& nodes = bucket->nodes;
+                for (const ListHook* hook = nodes.front(); hook != nodes.end(); hook = hook->next) {
+                    if (total + weight <= capacity) {
+                        return;
+                    }
+                    const Node& node = *static_cast<const Node*>(hook);
+                    total -= node.weight();
+                    if (!visit(node)) {
+                        return;
+                    }
+                }
+            }
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        size_t weight() const {
+            return total_weight;
+        }
+
+        size_t ghostSize() const {
+            return 0;
+        }
+
+        uint64_t state() const {
+            return 0;
+        }
+
+        void restoreState(uint64_t) {}
+
+        void addGauges(CacheStatsSnapshot&) const {}
+    };
+};
+
+// 自适应替换：T1/T2常驻，B1/B2是只保留键的幽灵条目，p是T1的目标权重。
+// 列表大小、p和capacity都按权重计算，默认每个条目权重为1(即标准ARC)；幽灵条目保留降级前的权重，
+// 用于目录大小限制和p的调整
+struct ArcEviction {
+    enum ListId : uint8_t { T1 = 0, T2 = 1, B1 = 2, B2 = 3 };
+
+    struct Hook : ListHook {
+        ListId list;
+    };
+
+    template<typename Node>
+    class Policy {
+    private:
+        IntrusiveList lists[4];
+        size_t list_weight[4];
+        size_t capacity;
+        size_t p;
+
+        void link(Node& node, ListId to) {
+            lists[to].pushBack(&node);
+            list_weight[to] += node.weight();
+            node.list = to;
+        }
+
+        void unlink(Node& node) {
+            lists[node.list].remove(&node);
+            list_weight[node.list] -= node.weight();
+        }
+
+        // 移到目标列表尾部(最近使用)
+        void moveTo(Node& node, ListId to) {
+            unlink(node);
+            link(node, to);
+        }
+
+        // 修改条目权重，同时修正所在列表的总权重
+        void reweigh(Node& node, size_t weight) {
+            list_weight[node.list] = list_weight[node.list] - node.weight() + weight;
+            node.setWeight(weight);
+        }
+
+        Node& front(ListId id) const {
+            return *static_cast<Node*>(lists[id].front());
+        }
+
+        size_t totalWeight() const {
+            return list_weight[T1] + list_weight[T2] + list_weight[B1] + list_weight[B2];
+        }
+
+        // 替换时从T1还是T2淘汰
+        bool replaceFromT1(bool in_b2) const {
+            size_t t1 = list_weight[T1];
+            return !lists[T1].empty() && (t1 > p || (in_b2 && t1 == p) || lists[T2].empty());
+        }
+
+        // 从T1或T2淘汰一个条目到对应的幽灵列表
+        template<typename Ops>
+        void replace(bool in_b2, Ops& ops) {
+            bool from_t1 = replaceFromT1(in_b2);
+            Node& victim = front(from_t1 ? T1 : T2);
+            ops.demote(victim);
+            moveTo(victim, from_t1 ? B1 : B2);
+        }
+
+        // 淘汰常驻条目，直到还能放下weight
+        template<typename Ops>
+        void makeRoom(size_t weight, bool in_b2, Ops& ops) {
+            while (size() > 0 && list_weight[T1] + list_weight[T2] + weight > capacity) {
+                replace(in_b2, ops);
+            }
+        }
+
+        // 彻底删除某个幽灵列表最久未使用的条目
+        template<typename Ops>
+        void forgetFront(ListId id, Ops& ops) {
+            Node& ghost = front(id);
+            unlink(ghost);
+            ops.forget(ghost);
+        }
+
+    public:
+        explicit Policy(size_t cap) : list_weight{0, 0, 0, 0}, capacity(cap), p(0) {}
+
+        bool resident(const Node& node) const {
+            return node.list == T1 || node.list == T2;
+        }
+
+        // 命中时T1晋升到T2，T2移到尾部
+        void onHit(Node& node) {
+            moveTo(node, T2);
+        }
+
+        template<typename Ops>
+        void onInsert(Node& node, Ops& ops) {
+            size_t weight = node.weight();
+            // L1(T1 + B1)最多容纳capacity的权重，优先丢弃B1中的幽灵
+            while (list_weight[T1] + list_weight[B1] + weight > capacity) {
+                if (!lists[B1].empty()) {
+                    forgetFront(B1, ops);
+                } else if (!lists[T1].empty()) {
+                    Node& victim = front(T1);
+                    unlink(victim);
+                    ops.evict(victim);
+                } else {
+                    break;
+                }
+            }
+            // 幽灵历史使整个目录最多容纳2 * capacity的权重
+            while (totalWeight() + weight > 2 * capacity && !lists[B2].empty()) {
+                forgetFront(B2, ops);
+            }
+            makeRoom(weight, false, ops);
+            link(node, T1);
+        }
+
+        // 更新值并移动到T2尾部，值变大时淘汰其他条目
+        template<typename Ops>
+        void onUpdate(Node& node, size_t weight, Ops& ops) {
+            reweigh(node, weight);
+            moveTo(node, T2);
+            while (list_weight[T1] + list_weight[T2] > capacity && size() > 1) {
+                replace(false, ops);
+            }
+        }
+
+        // B1命中说明T1太小，增加p；B2命中说明T2太小，减少p。幽灵条目重新载入后放入T2
+        template<typename Ops>
+        CacheCounter onGhostHit(Node& node, size_t weight, Ops& ops) {
+            size_t b1 = list_weight[B1], b2 = list_weight[B2];
+            bool in_b2 = node.list == B2;
+            if (in_b2) {
+                size_t delta = std::max(b1 / std::max(b2, size_t(1)), size_t(1)) * node.weight();
+                p = p > delta ? p - delta : 0;
+            } else {
+                size_t delta = std::max(b2 / std::max(b1, size_t(1)), size_t(1)) * node.weight();
+                p = std::min(p + delta, capacity);
+            }
+            makeRoom(weight, in_b2, ops);
+            reweigh(node, weight);
+            moveTo(node, T2);
+            return in_b2 ? kGhostHitsB2 : kGhostHitsB1;
+        }
+
+        void onErase(Node& node) {
+            unlink(node);
+        }
+
+        // 放回原来的列表，排在重启后进入该列表的条目之前，超出列表大小限制的条目被丢弃。
+        // meta低2位是所在列表，其余位是幽灵条目的权重
+        template<typename Ops>
+        bool onRestore(Node& node, bool has_value, uint32_t meta, Ops&) {
+            ListId id = static_cast<ListId>(meta & 3);
+            bool ghost = id == B1 || id == B2;
+            if (ghost == has_value) {
+                return false;
+            }
+            if (ghost) {
+                node.setWeight(std::max<size_t>(meta >> 2, 1));
+            }
+            size_t weight = node.weight();
+            if ((!ghost && weight + list_weight[T1] + list_weight[T2] > capacity) ||
+                ((id == T1 || id == B1) && weight + list_weight[T1] + list_weight[B1] > capacity) ||
+                weight + totalWeight() > 2 * capacity) {
+                return false;
+            }
+            lists[id].pushRestored(&node);
+            list_weight[id] += weight;
+            node.list = id;
+            return true;
+        }
+
+        // 依次按T1、T2、B1、B2，每个列表从最久未使用到最近使用
+        template<typename Visitor>
+        void forEach(Visitor visit) const {
+            for (int id = T1; id <= B2; id++) {
+                lists[id].template forEach<Node>([&visit, id](const Node& node) {
+                    uint32_t weight = static_cast<uint32_t>(std::min<size_t>(node.weight(), UINT32_MAX >> 2));
+                    visit(node, (weight << 2) | static_cast<uint32_t>(id));
+                });
+            }
+        }
+
+        Node* victim() const {
+            if (size() == 0) {
+                return nullptr;
+            }
+            return &front(replaceFromT1(false) ? T1 : T2);
+        }
+
+        // 按onInsert的步骤模拟：先按L1上限丢弃B1中的幽灵(B1为空时淘汰T1)，再按p在T1和T2之间选择淘汰，
+        // 只访问被淘汰的常驻条目，不访问被丢弃的幽灵
+        template<typename Visitor>
+        void forEachVictim(size_t weight, Visitor visit) const {
+            size_t t1 = list_weight[T1], t2 = list_weight[T2], b1 = list_weight[B1];
+            const ListHook* next_t1 = lists[T1].front();
+            const ListHook* next_t2 = lists[T2].front();
+            const ListHook* next_b1 = lists[B1].front();
+            while (t1 + b1 + weight > capacity) {
+                if (next_b1 != lists[B1].end()) {
+                    b1 -= static_cast<const Node*>(next_b1)->weight();
+                    next_b1 = next_b1->next;
+                } else if (next_t1 != lists[T1].end()) {
+                    const Node& node = *static_cast<const Node*>(next_t1);
+                    t1 -= node.weight();
+                    next_t1 = next_t1->next;
+                    if (!visit(node)) {
+                        return;
+                    }
+                } else {
+                    break;
+                }
+            }
+            while (t1 + t2 + weight > capacity) {
+                bool t1_left = next_t1 != lists[T1].end(), t2_left = next_t2 != lists[T2].end();
+                if (!t1_left && !t2_left) {
+                    return;
+                }
+                bool from_t1 = t1_left && (t1 > p || !t2_left);
+                const ListHook*& next = from_t1 ? next_t1 : next_t2;
+                const Node& node = *static_cast<const Node*>(next);
+                (from_t1 ? t1 : t2) -= node.weight();
+                next = next->next;
+                if (!visit(node)) {
+                    return;
+                }
+            }
+        }
+
+        size_t size() const {
+            return lists[T1].size() + lists[T2].size();
+        }
+
+        size_t weight() const {
+            return list_weight[T1] + list_weight[T2];
+        }
+
+        size_t ghostSize() const {
+            return lists[B1].size() + lists[B2].size();
+        }
+
+        // 策略状态是T1的目标权重p
+        uint64_t state() const {
+            return p;
+        }
+
+        void restoreState(uint64_t state) {
+            p = std::min<size_t>(state, capacity);
+        }
+
+        // p和四个列表的权重，观察p随负载的变化
+        void addGauges(CacheStatsSnapshot& s) const {
+            s.gauges = {{"arc_p", static_cast<double>(p)},
+                        {"arc_t1_weight", static_cast<double>(list_weight[T1])},
+                        {"arc_t2_weight", static_cast<double>(list_weight[T2])},
+                        {"arc_b1_weight", static_cast<double>(list_weight[B1])},
+                        {"arc_b2_weight", static_cast<double>(list_weight[B2])}};
+        }
+    };
+};
+
+template<typename Key, typename Value, typename Eviction, typename Hash = CacheHash<Key>,
+         typename Alloc = std::allocator<Value>, typename Stats = NoStats, typename Expiry = NoExpiry,
+         typename Lock = NoLock, typename Weigher = UnitWeigher>
+class Cache {
+public:
+    // 淘汰回调：条目因容量不足被淘汰(包括ARC降为幽灵)之前调用，显式删除、更新和过期不调用
+    typedef std::function<void(const Key&, const Value&)> Listener;
+
+private:
+    // 策略的元数据、过期时间和权重作为基类嵌入节点，空类型不占空间
+    struct Node : Eviction::Hook, Expiry::Stamp, EntryWeight<Weigher> {
+        Key key;
+        Value value;
+
+        template<typename K, typename V>
+        Node(K&& k, V&& v) : key(std::forward<K>(k)), value(std::forward<V>(v)) {}
+    };
+
+    typedef typename Eviction::template Policy<Node> PolicyType;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Node> NodeAlloc;
+    typedef std::allocator_traits<NodeAlloc> NodeTraits;
+
+    // 字符串键的索引只保存指向节点中键的string_view，每个键只存一份(节点地址不变，键在节点释放前移出索引)
+    typedef typename std::conditional<std::is_same<Key, std::string>::value, std::string_view, Key>::type IndexKey;
+
+    FlatHashMap<IndexKey, Node*, Hash> index;
+    PolicyType policy;
+    NodeAlloc allocator;
+    Stats counters;
+    Expiry expiry;
+    Weigher weigher;
+    mutable Lock mutex;
+    size_t capacity;
+    bool reject_oversize;  // 为true时不接收权重超过capacity的条目，否则淘汰其余所有条目后单独保存
+    Listener on_evict;
+
+    template<typename K, typename V>
+    Node* create(K&& key, V&& value) {
+        Node* node = NodeTraits::allocate(allocator, 1);
+        NodeTraits::construct(allocator, node, std::forward<K>(key), std::forward<V>(value));
+        return node;
+    }
+
+    void free(Node* node) {
+        expiry.release(*node);
+        NodeTraits::destroy(allocator, node);
+        NodeTraits::deallocate(allocator, node, 1);
+    }
+
+    void destroy(Node* node) {
+        index.erase(node->key);
+        free(node);
+    }
+
+    template<typename K, typename V>
+    size_t weigh(const K& key, const V& value) {
+        return EntryWeight<Weigher>::compute(weigher, key, value);
+    }
+
+    bool oversize(size_t weight) const {
+        return reject_oversize && weight > capacity;
+    }
+
+    // 策略通过它淘汰条目
+    struct Ops {
+        Cache& cache;
+
+        void evict(Node& node) {
+            if (cache.on_evict) {
+                cache.on_evict(node.key, node.value);
+            }
+            cache.counters.record(kEvictions);
+            cache.destroy(&node);
+        }
+
+        void demote(Node& node) {
+            if (cache.on_evict) {
+                cache.on_evict(node.key, node.value);
+            }
+            cache.expiry.release(node);
+            node.value = Value();
+            cache.counters.record(kEvictions);
+        }
+
+        void forget(Node& node) {
+            cache.destroy(&node);
+        }
+    };
+
+    // 删除到期的条目
+    void expire(typename Expiry::Stamp* stamp) {
+        Node* node = static_cast<Node*>(stamp);
+        expiry.onExpire(*node);
+        policy.onErase(*node);
+        destroy(node);
+    }
+
+    // 推进过期时钟，删除时间轮报告的到期条目
+    void tick() {
+        expiry.tick([this](typename Expiry::Stamp* stamp) { expire(stamp); });
+    }
+
+    // 查找常驻且未过期的条目，已过期的删除
+    template<typename LookupKey>
+    Node* lookup(const LookupKey& key) {
+        tick();
+        auto it = index.find(key);
+        if (it == index.end() || !policy.resident(*it->second)) {
+            return nullptr;
+        }
+        Node* node = it->second;
+        if (expiry.expired(*node)) {
+            expire(node);
+            return nullptr;
+        }
+        return node;
+    }
+
+    // 写入值，make()构造新值；键已常驻时overwrite为false则不做任何修改，返回是否写入
+    template<typename K, typename Make>
+    bool store(K&& key, Make make, bool overwrite) {
+        if (capacity == 0) {
+            return false;
+        }
+        tick();
+        Ops ops{*this};
+        auto it = index.find(key);
+        if (it != index.end()) {
+            Node* node = it->second;
+            bool resident = policy.resident(*node);
+            if (resident && !overwrite) {
+                return false;
+            }
+            Value value = make();
+            size_t weight = weigh(node->key, value);
+            if (oversize(weight)) {
+                if (resident) {
+                    // 新值放不下，删除旧值，避免之后读到过期数据
+                    policy.onErase(*node);
+                    destroy(node);
+                }
+                return false;
+            }
+            if (resident) {
+                // 节点可能在onUpdate中被淘汰，之后不再访问
+                node->value = std::move(value);
+                expiry.stamp(*node);
+                counters.record(kUpdates);
+                policy.onUpdate(*node, weight, ops);
+            } else {
+                counters.record(policy.onGhostHit(*node, weight, ops));
+                node->value = std::move(value);
+                expiry.stamp(*node);
+                counters.record(kInserts);
+            }
+            return true;
+        }
+
+        Node* node = create(std::forward<K>(key), make());
+        size_t weight = weigh(node->key, node->value);
+        if (oversize(weight)) {
+            free(node);
+            return false;
+        }
+        node->setWeight(weight);
+        policy.onInsert(*node, ops);
+        index[node->key] = node;
+        expiry.stamp(*node);
+        counters.record(kInserts);
+        return true;
+    }
+
+public:
+    explicit Cache(size_t cap, Expiry e = Expiry(), Alloc alloc = Alloc(), Weigher w = Weigher(),
+                   bool reject = false)
+        : policy(cap), allocator(alloc), expiry(std::move(e)), weigher(std::move(w)), capacity(cap),
+          reject_oversize(reject) {}
+
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+
+    ~Cache() {
+        for (auto it = index.begin(); it != index.end(); ++it) {
+            free(it->second);
+        }
+    }
+
+    template<typename LookupKey>
+    bool get(const LookupKey& key, Value& value) {
+        return read(key, [&value](const Value& v) { value = v; });
+    }
+
+    // 命中时在锁内调用on_hit(const Value&)，由调用者决定拷贝什么，返回是否命中
+    template<typename LookupKey, typename Callback>
+    bool read(const LookupKey& key, Callback on_hit) {
+        std::lock_guard<Lock> guard(mutex);
+        Node* node = lookup(key);
+        if (!node) {
+            counters.record(kMisses);
+            return false;
+        }
+        policy.onHit(*node);
+        expiry.touch(*node);
+        on_hit(node->value);
+        counters.record(kHits);
+        return true;
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        std::lock_guard<Lock> guard(mutex);
+        store(std::forward<K>(key), [&value]() { return Value(std::forward<V>(value)); }, true);
+    }
+
+    // 键已常驻时不做任何修改，否则写入make()构造的值(make只在需要时调用)，返回是否写入
+    template<typename K, typename Make>
+    bool emplaceWith(K&& key, Make make) {
+        std::lock_guard<Lock> guard(mutex);
+        return store(std::forward<K>(key), make, false);
+    }
+
+    template<typename K, typename... Args>
+    bool emplace(K&& key, Args&&... args) {
+        return emplaceWith(std::forward<K>(key), [&]() { return Value(std::forward<Args>(args)...); });
+    }
+
+    void setEvictionListener(Listener listener) {
+        std::lock_guard<Lock> guard(mutex);
+        on_evict = std::move(listener);
+    }
+
+    // 删除键(包括幽灵条目)，返回键是否常驻
+    template<typename LookupKey>
+    bool erase(const LookupKey& key) {
+        std::lock_guard<Lock> guard(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return false;
+        }
+        Node* node = it->second;
+        bool resident = policy.resident(*node);
+        policy.onErase(*node);
+        destroy(node);
+        return resident;
+    }
+
+    // 键是否常驻，不改变策略状态
+    template<typename LookupKey>
+    bool contains(const LookupKey& key) const {
+        std::lock_guard<Lock> guard(mutex);
+        auto it = index.find(key);
+        return it != index.end() && policy.resident(*it->second);
+    }
+
+    // 写入一个权重为weight的新键会淘汰的常驻条目：按淘汰顺序调用visit(key)，visit返回false时停止。
+    // 供准入过滤器与每个将被挤出的条目比较，不修改缓存
+    template<typename Visitor>
+    void forEachVictim(size_t weight, Visitor visit) const {
+        std::lock_guard<Lock> guard(mutex);
+        if (capacity == 0 || oversize(weight)) {
+            return;
+        }
+        policy.forEachVictim(weight, [&visit](const Node& node) { return visit(node.key); });
+    }
+
+    // 取出下一个将被淘汰的常驻条目(不调用淘汰回调，不计入淘汰)，用于把条目迁移到另一个缓存
+    bool takeVictim(Key& key, Value& value) {
+        std::lock_guard<Lock> guard(mutex);
+        Node* node = policy.victim();
+        if (!node) {
+            return false;
+        }
+        key = node->key;
+        value = std::move(node->value);
+        policy.onErase(*node);
+        destroy(node);
+        return true;
+    }
+
+    // 常驻条目数
+    size_t size() const {
+        std::lock_guard<Lock> guard(mutex);
+        return policy.size();
+    }
+
+    const Weigher& entryWeigher() const {
+        return weigher;
+    }
+
+    // 过期策略本身，供包装设置单次写入的参数、读取过期计数，调用者负责同步
+    Expiry& expiryPolicy() {
+        return expiry;
+    }
+
+    const Expiry& expiryPolicy() const {
+        return expiry;
+    }
+
+    // 读取时钟并删除所有到期的条目，访问稀疏时可以定期调用以释放内存
+    void advanceClock() {
+        std::lock_guard<Lock> guard(mutex);
+        expiry.advance([this](typename Expiry::Stamp* stamp) { expire(stamp); });
+    }
+
+    // 常驻条目的总权重
+    size_t weight() const {
+        std::lock_guard<Lock> guard(mutex);
+        return policy.weight();
+    }
+
+    // 幽灵条目数(只有ARC有)
+    size_t ghostSize() const {
+        std::lock_guard<Lock> guard(mutex);
+        return policy.ghostSize();
+    }
+
+    // 快照接口：按策略的恢复顺序访问所有条目，visit(key, 值的指针或nullptr(幽灵条目), meta)
+    template<typename Visitor>
+    void forEachEntry(Visitor visit) const {
+        std::lock_guard<Lock> guard(mutex);
+        policy.forEach([this, &visit](const Node& node, uint32_t meta) {
+            visit(node.key, policy.resident(node) ? &node.value : nullptr, meta);
+        });
+    }
+
+    // 按forEachEntry的顺序逐条恢复，value为nullptr表示幽灵条目
+    template<typename K>
+    bool restoreEntry(K&& key, const Value* value, uint32_t meta) {
+        std::lock_guard<Lock> guard(mutex);
+        if (capacity == 0 || index.find(key) != index.end()) {
+            return false;
+        }
+        tick();
+        Node* node = create(std::forward<K>(key), value ? *value : Value());
+        if (value) {
+            size_t weight = weigh(node->key, node->value);
+            if (oversize(weight)) {
+                free(node);
+                return false;
+            }
+            node->setWeight(weight);
+        }
+        Ops ops{*this};
+        if (!policy.onRestore(*node, value != nullptr, meta, ops)) {
+            free(node);
+            return false;
+        }
+        index[node->key] = node;
+        if (value) {
+            expiry.stamp(*node);
+        }
+        return true;
+    }
+
+    uint64_t policyState() const {
+        std::lock_guard<Lock> guard(mutex);
+        return policy.state();
+    }
+
+    void restorePolicyState(uint64_t state) {
+        std::lock_guard<Lock> guard(mutex);
+        policy.restoreState(state);
+    }
+
+    // 计数之外附带策略的瞬时值(如ARC的p)
+    CacheStatsSnapshot stats() const {
+        CacheStatsSnapshot s = counters.snapshot();
+        std::lock_guard<Lock> guard(mutex);
+        policy.addGauges(s);
+        return s;
+    }
+};
+
+// 字符串键、值句柄的缓存：Cache<std::string, std::shared_ptr<const T>, Eviction, ...>的适配，
+// FIFOCache/LRUCache/LFUCache/ARCCache都由它实现。值由shared_ptr持有，get可以直接返回句柄，
+// 更新时换成新的值对象，已发出的句柄仍指向旧值；幽灵条目的句柄为空，只保留键。
+// capacity是权重上限：默认每个条目权重为1(即条目数)，使用ByteWeigher时为字节预算。带统计，不加锁。
+// Expiry默认不过期，ExpiringCache换成把定时器嵌入节点的过期策略。
+template<typename T, typename Eviction, typename Weigher = UnitWeigher, typename Expiry = NoExpiry>
+class HandleCache {
+private:
+    typedef std::shared_ptr<const T> ValuePtr;
+
+    // 把权重函数作用在句柄指向的值上
+    struct HandleWeigher {
+        Weigher weigher;
+
+        explicit HandleWeigher(Weigher w) : weigher(std::move(w)) {}
+
+        size_t operator()(const std::string& key, const ValuePtr& value) {
+            return weigher(std::string_view(key), *value);
+        }
+    };
+
+    // 还没有写入的条目的权重
+    static size_t weightOf(const UnitWeigher&, std::string_view, const T&) {
+        return 1;
+    }
+
+    static size_t weightOf(const HandleWeigher& w, std::string_view key, const T& value) {
+        return w.weigher(key, value);
+    }
+
+    typedef typename std::conditional<std::is_same<Weigher, UnitWeigher>::value, UnitWeigher, HandleWeigher>::type
+        EntryWeigher;
+
+    Cache<std::string, ValuePtr, Eviction, CacheHash<std::string>, std::allocator<ValuePtr>, CacheStats, Expiry,
+          NoLock, EntryWeigher> cache;
+
+public:
+    explicit HandleCache(size_t cap, Weigher w = Weigher(), bool reject = false)
+        : cache(cap, Expiry(), std::allocator<ValuePtr>(), EntryWeigher(std::move(w)), reject) {}
+
+    bool get(std::string_view key, T& value) {
+        return cache.read(key, [&value](const ValuePtr& v) { value = *v; });
+    }
+
+    // 返回值句柄而不拷贝值，未命中时返回空句柄
+    ValueHandle<T> get(std::string_view key) {
+        ValueHandle<T> handle;
+        cache.read(key, [&handle](const ValuePtr& v) { handle = v; });
+        return handle;
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        cache.put(std::forward<K>(key), std::make_shared<T>(std::forward<V>(value)));
+    }
+
+    // 原地构造值，键已常驻或条目被拒绝时不做任何修改，返回是否插入
+    template<typename K, typename... Args>
+    bool emplace(K&& key, Args&&... args) {
+        return cache.emplaceWith(std::forward<K>(key),
+                                 [&]() { return ValuePtr(std::make_shared<T>(std::forward<Args>(args)...)); });
+    }
+
+    // 设置淘汰回调，在条目被淘汰之前调用
+    void setEvictionListener(EvictionListener<T> listener) {
+        if (!listener) {
+            cache.setEvictionListener(nullptr);
+            return;
+        }
+        cache.setEvictionListener([listener](const std::string& key, const ValuePtr& value) {
+            listener(key, *value);
+        });
+    }
+
+    // 删除键(ARC包括幽灵历史)，返回键是否常驻
+    bool erase(std::string_view key) {
+        return cache.erase(key);
+    }
+
+    bool contains(std::string_view key) const {
+        return cache.contains(key);
+    }
+
+    // 写入key和value会淘汰的常驻条目(按权重计算，可能不止一个)：按淘汰顺序调用visit(key)，visit返回false时停止。
+    // key已常驻时是更新，不按新键计算
+    template<typename Visitor>
+    void forEachVictim(std::string_view key, const T& value, Visitor visit) const {
+        if (cache.contains(key)) {
+            return;
+        }
+        cache.forEachVictim(weightOf(cache.entryWeigher(), key, value),
+                            [&visit](const std::string& victim) { return visit(victim); });
+    }
+
+    // 取出下一个将被淘汰的常驻条目，不调用淘汰回调
+    bool takeVictim(std::string& key, ValueHandle<T>& value) {
+        return cache.takeVictim(key, value);
+    }
+
+    Expiry& expiryPolicy() {
+        return cache.expiryPolicy();
+    }
+
+    const Expiry& expiryPolicy() const {
+        return cache.expiryPolicy();
+    }
+
+    // 删除所有到期的条目
+    void advanceClock() {
+        cache.advanceClock();
+    }
+
+    // 常驻条目数
+    size_t size() const {
+        return cache.size();
+    }
+
+    // 常驻条目的总权重
+    size_t weight() const {
+        return cache.weight();
+    }
+
+    // 幽灵条目的数量
+    size_t ghostSize() const {
+        return cache.ghostSize();
+    }
+
+    // 快照接口：按策略的恢复顺序访问所有条目，visit(key, 值或nullptr(幽灵条目), meta)，meta的含义由策略决定
+    template<typename Visitor>
+    void forEachEntry(Visitor visit) const {
+        cache.forEachEntry([&visit](const std::string& key, const ValuePtr* value, uint32_t meta) {
+            visit(std::string_view(key), value ? value->get() : nullptr, meta);
+        });
+    }
+
+    // 按forEachEntry的顺序逐条恢复
+    bool restoreEntry(std::string_view key, const T* value, uint32_t meta) {
+        if (!value) {
+            return cache.restoreEntry(key, nullptr, meta);
+        }
+        ValuePtr copy = std::make_shared<T>(*value);
+        return cache.restoreEntry(key, &copy, meta);
+    }
+
+    uint64_t policyState() const {
+        return cache.policyState();
+    }
+
+    void restorePolicyState(uint64_t state) {
+        cache.restorePolicyState(state);
+    }
+
+    // 命中、未命中、插入、更新、淘汰计数，ARC附带p和四个列表的权重
+    CacheStatsSnapshot stats() const {
+        return cache.stats();
+    }
+};
+
+// 同一种缓存换用另一种过期策略：WithExpiry<LRUCache<T, Weigher>, E>::type是LRUCache<T, Weigher, E>
+template<typename CacheType, typename Expiry>
+struct WithExpiry;
+
+template<template<typename, typename, typename> class CacheTemplate, typename T, typename Weigher, typename OldExpiry,
+         typename Expiry>
+struct WithExpiry<CacheTemplate<T, Weigher, OldExpiry>, Expiry> {
+    typedef CacheTemplate<T, Weigher, Expiry> type;
+};
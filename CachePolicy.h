@@ -1,17 +1,46 @@
 #pragma once
 
+#include <functional>
 #include <string>
-#include <chrono>
+#include <memory>
+#include <string_view>
+#include <utility>
 
-// 缓存项结构
+// get返回的值句柄，持有句柄期间条目的值不会被释放或修改(更新会换成新的值对象)，读取时无需拷贝
 template<typename T>
-struct CacheItem {
-    std::string key;
-    T value;
-    int frequency;  // 用于LFU
-    std::chrono::steady_clock::time_point last_accessed; // 用于LRU
-    
-    CacheItem(const std::string& k, const T& v) : key(k), value(v), frequency(1) {
-        last_accessed = std::chrono::steady_clock::now();
+using ValueHandle = std::shared_ptr<const T>;
+
+// 淘汰回调：条目因容量不足被淘汰时调用(显式删除和更新不调用)，可用于把条目写入下一级存储
+template<typename T>
+using EvictionListener = std::function<void(const std::string& key, const T& value)>;
+
+// 权重函数：返回一个条目占用多少容量。默认每个条目权重为1，此时capacity就是条目数上限
+struct UnitWeigher {
+    template<typename T>
+    size_t operator()(std::string_view, const T&) const {
+        return 1;
+    }
+};
+
+// 按字节计算权重：键长度 + 值占用的字节 + 每个条目的固定开销(链表节点、索引槽位、shared_ptr控制块等)
+// 此时capacity是字节预算
+struct ByteWeigher {
+    size_t entry_overhead;
+
+    explicit ByteWeigher(size_t overhead = 128) : entry_overhead(overhead) {}
+
+    template<typename T>
+    size_t operator()(std::string_view key, const T& value) const {
+        return key.size() + valueBytes(value) + entry_overhead;
+    }
+
+private:
+    static size_t valueBytes(const std::string& value) {
+        return sizeof(std::string) + value.size();
+    }
+
+    template<typename T>
+    static size_t valueBytes(const T&) {
+        return sizeof(T);
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "FlatHashMap.h"
+#include "KeyCodec.h"
+
+// 缓存快照文件
+// 文件头(64字节) + 记录区 + 哈希索引区。记录按策略的恢复顺序排列(LRU/FIFO从旧到新，LFU按频率升序，
+// ARC按T1、T2、B1、B2各自从旧到新)，每条记录带有策略元数据(LFU频率、ARC所在列表)和自己的校验和。
+// 哈希索引是开放寻址表，保存记录的偏移，映射文件后不解析记录就可以按键查找。
+// 文件头有独立的校验和；记录的校验和在读取该记录时才验证，打开多GB的快照不需要扫描整个文件。
+// 所有整数按本机字节序写入，快照只用于同一台机器上的重启。
+namespace CacheSnapshot {
+    const char kMagic[4] = {'C', 'S', 'N', 'P'};
+    const uint32_t kVersion = 1;
+    const uint32_t kHasValue = 1;  // 记录带有值(ARC的幽灵条目没有值)
+    const char kPadding[8] = {};
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        char policy[16];          // 策略名，恢复到不同策略时只恢复键值和顺序
+        uint64_t record_count;
+        uint64_t policy_state;    // 策略的全局状态，如ARC的p
+        uint64_t index_offset;
+        uint64_t index_slots;     // 2的幂
+        uint64_t checksum;        // 之前所有字段的校验和
+    };
+
+    struct RecordHeader {
+        uint32_t key_len;
+        uint32_t value_len;
+        uint32_t meta;
+        uint32_t flags;
+        uint64_t checksum;        // 长度、元数据和键值内容的校验和
+    };
+
+    static_assert(sizeof(Header) == 64, "unexpected snapshot header layout");
+    static_assert(sizeof(RecordHeader) == 24, "unexpected snapshot record layout");
+
+    // 校验和与索引中的键哈希都用KeyCodec::checksum(FNV-1a)，与标准库无关
+    inline uint64_t recordChecksum(const RecordHeader& r, const char* key, const char* value) {
+        uint64_t h = KeyCodec::checksum(&r, offsetof(RecordHeader, checksum));
+        h = KeyCodec::checksum(key, r.key_len, h);
+        return KeyCodec::checksum(value, r.value_len, h);
+    }
+
+    inline uint64_t headerChecksum(const Header& h) {
+        return KeyCodec::checksum(&h, offsetof(Header, checksum));
+    }
+
+    inline uint64_t keyHash(std::string_view key) {
+        return KeyCodec::checksum(key.data(), key.size());
+    }
+
+    inline size_t align8(size_t n) {
+        return (n + 7) & ~size_t(7);
+    }
+}
+
+// 把缓存内容和策略状态写入快照文件。先写临时文件再rename，写入中途崩溃不会破坏旧快照
+// CacheType需要提供kPolicyName、forEachEntry(visitor)和policyState()
+template<typename CacheType>
+bool saveSnapshot(const CacheType& cache, const std::string& path) {
+    using namespace CacheSnapshot;
+    std::string tmp_path = path + ".tmp";
+    FILE* file = std::fopen(tmp_path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Cannot create snapshot " << tmp_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(header.magic));
+    header.version = kVersion;
+    std::strncpy(header.policy, CacheType::kPolicyName, sizeof(header.policy) - 1);
+    header.policy_state = cache.policyState();
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    uint64_t offset = sizeof(header);
+    std::vector<std::pair<uint64_t, uint64_t>> entries;  // (键哈希, 记录偏移)
+    std::string encoded;
+    cache.forEachEntry([&](std::string_view key, const auto* value, uint32_t meta) {
+        if (!ok) {
+            return;
+        }
+        encoded.clear();
+        if (value) {
+            KeyCodec::encodeValue(*value, encoded);
+        }
+        RecordHeader record;
+        record.key_len = static_cast<uint32_t>(key.size());
+        record.value_len = static_cast<uint32_t>(encoded.size());
+        record.meta = meta;
+        record.flags = value ? kHasValue : 0;
+        record.checksum = recordChecksum(record, key.data(), encoded.data());
+        size_t body = key.size() + encoded.size();
+        size_t padding = align8(body) - body;
+        ok = std::fwrite(&record, sizeof(record), 1, file) == 1 &&
+             std::fwrite(key.data(), 1, key.size(), file) == key.size() &&
+             std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size() &&
+             std::fwrite(kPadding, 1, padding, file) == padding;
+        entries.emplace_back(keyHash(key), offset);
+        offset += sizeof(record) + align8(body);
+    });
+
+    // 索引负载不超过50%，槽位保存记录偏移+1，0表示空
+    uint64_t slots = 16;
+    while (slots < entries.size() * 2) {
+        slots <<= 1;
+    }
+    std::vector<uint64_t> index(slots, 0);
+    for (const auto& entry : entries) {
+        uint64_t slot = entry.first & (slots - 1);
+        while (index[slot] != 0) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        index[slot] = entry.second + 1;
+    }
+    ok = ok && std::fwrite(index.data(), sizeof(uint64_t), slots, file) == slots;
+
+    header.record_count = entries.size();
+    header.index_offset = offset;
+    header.index_slots = slots;
+    header.checksum = headerChecksum(header);
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fflush(file) == 0 && ok;
+    ok = fsync(fileno(file)) == 0 && ok;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::cerr << "Write snapshot " << path << " failed" << std::endl;
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// 只读映射的快照。open只检查文件头，find按索引直接读取一条记录，forEach按恢复顺序遍历
+class MappedSnapshot {
+private:
+    const char* data;
+    size_t data_size;
+    CacheSnapshot::Header header;
+
+    void unmap() {
+        if (data) {
+            munmap(const_cast<char*>(data), data_size);
+            data = nullptr;
+        }
+    }
+
+    // 读取并校验offset处的记录，失败返回false
+    bool readRecord(uint64_t offset, std::string_view& key, std::string_view& value, uint32_t& meta,
+                    bool& has_value, uint64_t& next) const {
+        using namespace CacheSnapshot;
+        // offset可能来自损坏的索引，先比较再相减，避免溢出
+        if (offset >= header.index_offset || header.index_offset - offset < sizeof(RecordHeader)) {
+            return false;
+        }
+        RecordHeader record;
+        std::memcpy(&record, data + offset, sizeof(record));
+        uint64_t body = static_cast<uint64_t>(record.key_len) + record.value_len;
+        if (offset + sizeof(record) + body > header.index_offset) {
+            return false;
+        }
+        const char* key_data = data + offset + sizeof(record);
+        if (recordChecksum(record, key_data, key_data + record.key_len) != record.checksum) {
+            return false;
+        }
+        key = std::string_view(key_data, record.key_len);
+        value = std::string_view(key_data + record.key_len, record.value_len);
+        meta = record.meta;
+        has_value = (record.flags & kHasValue) != 0;
+        next = offset + sizeof(record) + align8(body);
+        return true;
+    }
+
+public:
+    MappedSnapshot() : data(nullptr), data_size(0) {
+        std::memset(&header, 0, sizeof(header));
+    }
+
+    ~MappedSnapshot() {
+        unmap();
+    }
+
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+
+    bool open(const std::string& path) {
+        using namespace CacheSnapshot;
+        unmap();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            return false;
+        }
+        data_size = st.st_size;
+        void* addr = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return false;
+        }
+        data = static_cast<const char*>(addr);
+        std::memcpy(&header, data, sizeof(header));
+        bool valid = std::memcmp(header.magic, kMagic, sizeof(header.magic)) == 0 &&
+                     header.version == kVersion && header.checksum == headerChecksum(header) &&
+                     header.index_slots != 0 && (header.index_slots & (header.index_slots - 1)) == 0 &&
+                     header.index_offset + header.index_slots * sizeof(uint64_t) <= data_size;
+        if (!valid) {
+            std::cerr << "Snapshot " << path << " is corrupt or has an unknown version" << std::endl;
+            unmap();
+            return false;
+        }
+        return true;
+    }
+
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    void close() {
+        unmap();
+    }
+
+    size_t size() const {
+        return data ? header.record_count : 0;
+    }
+
+    std::string policy() const {
+        return std::string(header.policy, strnlen(header.policy, sizeof(header.policy)));
+    }
+
+    uint64_t policyState() const {
+        return header.policy_state;
+    }
+
+    // 按键查找有值的记录，记录损坏时视为不存在。索引区没有校验和，最多探测index_slots次，
+    // 损坏的索引中没有空槽时也会结束
+    template<typename T>
+    bool find(std::string_view key, T& value) const {
+        if (!data) {
+            return false;
+        }
+        const char* index = data + header.index_offset;
+        uint64_t mask = header.index_slots - 1;
+        uint64_t slot = CacheSnapshot::keyHash(key) & mask;
+        for (uint64_t probes = 0; probes < header.index_slots; probes++, slot = (slot + 1) & mask) {
+            uint64_t entry;
+            std::memcpy(&entry, index + slot * sizeof(uint64_t), sizeof(entry));
+            if (entry == 0) {
+                return false;
+            }
+            std::string_view record_key, record_value;
+            uint32_t meta;
+            bool has_value;
+            uint64_t next;
+            if (readRecord(entry - 1, record_key, record_value, meta, has_value, next) && record_key == key) {
+                return has_value && KeyCodec::decodeValue(record_value, value);
+            }
+        }
+        return false;
+    }
+
+    // 从offset开始按恢复顺序遍历最多limit条记录，visitor(key, value或nullptr, meta)，返回下一条的偏移，
+    // 遍历结束返回0。第一条记录的偏移为sizeof(Header)
+    template<typename T, typename Visitor>
+    uint64_t forEach(uint64_t offset, size_t limit, Visitor visit) const {
+        if (!data) {
+            return 0;
+        }
+        T value;
+        for (size_t i = 0; i < limit; i++) {
+            std::string_view key, bytes;
+            uint32_t meta;
+            bool has_value;
+            uint64_t next;
+            if (offset >= header.index_offset || !readRecord(offset, key, bytes, meta, has_value, next)) {
+                return 0;
+            }
+            if (has_value && !KeyCodec::decodeValue(bytes, value)) {
+                return 0;
+            }
+            visit(key, has_value ? &value : nullptr, meta);
+            offset = next;
+        }
+        return offset < header.index_offset ? offset : 0;
+    }
+};
+
+// 从快照热启动的缓存包装
+// 构造时只映射快照文件，立即可用：get在底层缓存未命中时直接从映射中按索引读取并载入缓存。
+// restoreStep(n)按快照中的顺序把后续n条记录连同策略状态(LRU顺序、LFU频率、ARC列表和p)恢复到缓存，
+// 可以在空闲时分批调用；全部恢复后释放映射。重启后写入或删除过的键不再从快照读取，避免读到旧值。
+// 恢复期间缓存已经在处理请求，所以恢复只使用空闲容量，不淘汰重启后写入的条目，恢复的记录在淘汰顺序上排在它们之前；
+// 缓存满了之后剩余的记录被跳过。快照的策略与CacheType不同时，只恢复键值和顺序。与底层缓存一样不是线程安全的。
+template<typename CacheType, typename T = std::string>
+class WarmCache {
+private:
+    CacheType cache;
+    MappedSnapshot snapshot;
+    bool same_policy;
+    uint64_t restore_offset;
+    FlatHashMap<std::string, bool> superseded;  // 重启后写入、删除或已从快照载入的键，不包括快照中没有的键
+    size_t snapshot_hits;
+
+    void finishRestore() {
+        snapshot.close();
+        superseded.clear();
+        restore_offset = 0;
+    }
+
+public:
+    // 其余参数原样传给底层缓存的构造函数。快照不存在或损坏时从空缓存开始
+    template<typename... Args>
+    WarmCache(const std::string& snapshot_path, const Args&... args)
+        : cache(args...), same_policy(false), restore_offset(0), snapshot_hits(0) {
+        if (snapshot.open(snapshot_path)) {
+            same_policy = snapshot.policy() == CacheType::kPolicyName;
+            if (same_policy) {
+                cache.restorePolicyState(snapshot.policyState());
+            }
+            restore_offset = sizeof(CacheSnapshot::Header);
+        }
+    }
+
+    bool get(std::string_view key, T& value) {
+        if (cache.get(key, value)) {
+            return true;
+        }
+        if (!snapshot.isOpen() || superseded.find(key) != superseded.end()) {
+            return false;
+        }
+        // 快照中没有的键不记录，superseded的大小不随未命中的键增长
+        if (!snapshot.find(key, value)) {
+            return false;
+        }
+        superseded[key] = true;
+        snapshot_hits++;
+        cache.put(key, value);
+        return true;
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        if (snapshot.isOpen()) {
+            superseded[key] = true;
+        }
+        cache.put(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    bool erase(std::string_view key) {
+        if (snapshot.isOpen()) {
+            superseded[key] = true;
+        }
+        return cache.erase(key);
+    }
+
+    // 恢复快照中接下来的最多limit条记录，返回是否还有未恢复的记录
+    bool restoreStep(size_t limit) {
+        if (!snapshot.isOpen()) {
+            return false;
+        }
+        restore_offset = snapshot.forEach<T>(restore_offset, limit,
+                                             [this](std::string_view key, const T* value, uint32_t meta) {
+            if (superseded.find(key) != superseded.end()) {
+                return;
+            }
+            if (same_policy) {
+                cache.restoreEntry(key, value, meta);
+            } else if (value) {
+                cache.restoreEntry(key, value, 0);
+            }
+        });
+        if (restore_offset == 0) {
+            finishRestore();
+            return false;
+        }
+        return true;
+    }
+
+    bool restoring() const {
+        return snapshot.isOpen();
+    }
+
+    // 直接从快照读取(而不是由restoreStep恢复)的命中数
+    size_t snapshotHits() const {
+        return snapshot_hits;
+    }
+
+    size_t size() const {
+        return cache.size();
+    }
+
+    CacheType& underlying() {
+        return cache;
+    }
+};
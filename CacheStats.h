@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 编译时加上-DCACHE_STATS_ENABLED=0可以去掉所有统计，record()变为空函数
+#ifndef CACHE_STATS_ENABLED
+#define CACHE_STATS_ENABLED 1
+#endif
+
+enum CacheCounter {
+    kHits,
+    kMisses,
+    kInserts,
+    kUpdates,
+    kEvictions,
+    kGhostHitsB1,   // ARC：命中最近淘汰的T1条目
+    kGhostHitsB2,   // ARC：命中最近淘汰的T2条目
+    kLoads,         // LoadingCache：后端加载次数
+    kLoadNanos,     // LoadingCache：后端加载的总耗时
+    kCounterCount
+};
+
+// 某一时刻的统计值。gauges是策略特有的瞬时值(如ARC的p)，分片缓存合并时逐项相加
+struct CacheStatsSnapshot {
+    uint64_t counters[kCounterCount] = {};
+    std::vector<std::pair<std::string, double>> gauges;
+
+    uint64_t operator[](CacheCounter c) const {
+        return counters[c];
+    }
+
+    double hitRate() const {
+        uint64_t lookups = counters[kHits] + counters[kMisses];
+        return lookups ? static_cast<double>(counters[kHits]) / lookups : 0.0;
+    }
+
+    void merge(const CacheStatsSnapshot& other) {
+        for (int i = 0; i < kCounterCount; i++) {
+            counters[i] += other.counters[i];
+        }
+        for (const auto& gauge : other.gauges) {
+            bool found = false;
+            for (auto& mine : gauges) {
+                if (mine.first == gauge.first) {
+                    mine.second += gauge.second;
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) {
+                gauges.push_back(gauge);
+            }
+        }
+    }
+};
+
+// 分条的计数器：每个线程固定使用一个缓存行对齐的条带，不同线程基本不会写同一个缓存行。
+// 计数用relaxed原子加，读取快照时把所有条带相加，可以在其他线程写入时随时读取。
+class CacheStats {
+#if CACHE_STATS_ENABLED
+private:
+    static const size_t kStripes = 8;
+
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> values[kCounterCount];
+
+        Stripe() {
+            for (auto& v : values) {
+                v.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    Stripe stripes[kStripes];
+
+    static size_t stripeIndex() {
+        static std::atomic<size_t> next_stripe(0);
+        thread_local size_t index = next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+        return index;
+    }
+
+public:
+    void record(CacheCounter c, uint64_t n = 1) {
+        stripes[stripeIndex()].values[c].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    CacheStatsSnapshot snapshot() const {
+        CacheStatsSnapshot s;
+        for (const Stripe& stripe : stripes) {
+            for (int i = 0; i < kCounterCount; i++) {
+                s.counters[i] += stripe.values[i].load(std::memory_order_relaxed);
+            }
+        }
+        return s;
+    }
+
+    static constexpr bool enabled() {
+        return true;
+    }
+#else
+public:
+    void record(CacheCounter, uint64_t = 1) {}
+
+    CacheStatsSnapshot snapshot() const {
+        return CacheStatsSnapshot();
+    }
+
+    static constexpr bool enabled() {
+        return false;
+    }
+#endif
+};
+
+// 按Prometheus文本格式输出多个缓存的统计，每个指标一组，缓存名作为cache标签
+inline void writePrometheus(std::ostream& out, const std::vector<std::pair<std::string, CacheStatsSnapshot>>& caches) {
+    static const char* const kNames[kCounterCount] = {
+        "cache_hits_total", "cache_misses_total", "cache_inserts_total", "cache_updates_total",
+        "cache_evictions_total", "cache_ghost_hits_b1_total", "cache_ghost_hits_b2_total",
+        "cache_loads_total", "cache_load_seconds_total"};
+
+    for (int i = 0; i < kCounterCount; i++) {
+        out << "# TYPE " << kNames[i] << " counter\n";
+        for (const auto& cache : caches) {
+            out << kNames[i] << "{cache=\"" << cache.first << "\"} ";
+            if (i == kLoadNanos) {
+                out << cache.second.counters[i] / 1e9;
+            } else {
+                out << cache.second.counters[i];
+            }
+            out << "\n";
+        }
+    }
+
+    // 同名的gauge放在一组
+    std::vector<std::string> gauge_names;
+    for (const auto& cache : caches) {
+        for (const auto& gauge : cache.second.gauges) {
+            bool seen = false;
+            for (const std::string& name : gauge_names) {
+                seen = seen || name == gauge.first;
+            }
+            if (!seen) {
+                gauge_names.push_back(gauge.first);
+            }
+        }
+    }
+    for (const std::string& name : gauge_names) {
+        out << "# TYPE cache_" << name << " gauge\n";
+        for (const auto& cache : caches) {
+            for (const auto& gauge : cache.second.gauges) {
+                if (gauge.first == name) {
+                    out << "cache_" << name << "{cache=\"" << cache.first << "\"} " << gauge.second << "\n";
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include "FlatHashMap.h"
+
+// CLOCK缓存实现
+// 条目放在固定大小的环形数组中，每个条目有一个引用位。命中只把引用位置1(relaxed原子写)，
+// 不移动任何条目，因此get只需要读锁，多个线程可以同时读。
+// 淘汰时时钟指针扫过环形数组：引用位为1的清零并跳过，遇到引用位为0的条目就淘汰。
+template<typename T>
+class ClockCache {
+private:
+    struct Slot {
+        std::string key;
+        T value;
+        std::atomic<bool> referenced;
+
+        Slot() : referenced(false) {}
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    FlatHashMap<std::string, size_t> index;
+    size_t capacity;
+    size_t count;
+    size_t hand;
+    mutable std::shared_mutex mutex;
+
+    // 转动时钟指针，返回第一个引用位为0的槽位
+    size_t findVictim() {
+        while (slots[hand].referenced.load(std::memory_order_relaxed)) {
+            slots[hand].referenced.store(false, std::memory_order_relaxed);
+            hand = (hand + 1) % capacity;
+        }
+        size_t victim = hand;
+        hand = (hand + 1) % capacity;
+        return victim;
+    }
+
+public:
+    explicit ClockCache(size_t cap) : slots(new Slot[cap]), capacity(cap), count(0), hand(0) {}
+
+    bool get(const std::string& key, T& value) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            Slot& slot = slots[it->second];
+            value = slot.value;
+            slot.referenced.store(true, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void put(const std::string& key, const T& value) {
+        if (capacity == 0) {
+            return;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            // 更新值
+            Slot& slot = slots[it->second];
+            slot.value = value;
+            slot.referenced.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        size_t position;
+        if (count < capacity) {
+            position = count++;
+        } else {
+            // 缓存已满，就地复用被淘汰的槽位
+            position = findVictim();
+            index.erase(slots[position].key);
+        }
+
+        Slot& slot = slots[position];
+        slot.key = key;
+        slot.value = value;
+        slot.referenced.store(false, std::memory_order_relaxed);
+        index[key] = position;
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return count;
+    }
+};
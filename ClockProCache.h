@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include "FlatHashMap.h"
+
+// CLOCK-Pro缓存实现
+// 所有页面(热页、冷页、以及已淘汰但仍保留键的测试页)放在同一个环上，由三个指针管理：
+// - hand_cold：淘汰冷页。有引用的冷页升为热页，否则淘汰为测试页(释放值)
+// - hand_hot：把没有引用的热页降为冷页
+// - hand_test：清除过期的测试页
+// 测试页再次被访问说明它的重用距离较短，直接作为热页载入，同时增大冷页目标容量。
+// 与CLOCK一样，命中只设置引用位，get只需要读锁。
+template<typename T>
+class ClockProCache {
+private:
+    enum PageType { HOT, COLD, TEST };
+
+    struct Page {
+        std::string key;
+        T value;
+        PageType type;
+        std::atomic<bool> referenced;
+        Page* prev;
+        Page* next;
+
+        Page(const std::string& k, const T& v, PageType t)
+            : key(k), value(v), type(t), referenced(false), prev(this), next(this) {}
+    };
+
+    FlatHashMap<std::string, Page*> index;
+    Page* hand_hot;
+    Page* hand_cold;
+    Page* hand_test;
+    size_t capacity;     // 常驻页(热页+冷页)上限，测试页最多也保留capacity个
+    size_t cold_target;  // 冷页目标容量，随测试页命中自适应调整
+    size_t min_cold;     // 冷页目标容量下限，冷页过少时hand_cold每次淘汰都要扫过几乎整个环
+    size_t hot_count;
+    size_t cold_count;
+    size_t test_count;
+    mutable std::shared_mutex mutex;
+
+    // 在hand_hot之前插入页面，即环上"最新"的位置
+    void link(Page* page) {
+        if (!hand_hot) {
+            hand_hot = hand_cold = hand_test = page;
+            return;
+        }
+        page->next = hand_hot;
+        page->prev = hand_hot->prev;
+        hand_hot->prev->next = page;
+        hand_hot->prev = page;
+    }
+
+    void remove(Page* page) {
+        index.erase(page->key);
+        if (page->next == page) {
+            hand_hot = hand_cold = hand_test = nullptr;
+        } else {
+            if (hand_hot == page) {
+                hand_hot = page->next;
+            }
+            if (hand_cold == page) {
+                hand_cold = page->next;
+            }
+            if (hand_test == page) {
+                hand_test = page->next;
+            }
+            page->prev->next = page->next;
+            page->next->prev = page->prev;
+        }
+        delete page;
+    }
+
+    void runHandCold() {
+        Page* page = hand_cold;
+        hand_cold = page->next;
+        if (page->type == COLD && page->referenced.load(std::memory_order_relaxed)) {
+            // 冷页在测试期内被再次访问，升为热页
+            page->referenced.store(false, std::memory_order_relaxed);
+            page->type = HOT;
+            cold_count--;
+            hot_count++;
+        } else if (page->type == COLD) {
+            // 淘汰冷页，保留键作为测试页
+            T released;
+            std::swap(page->value, released);
+            page->type = TEST;
+            cold_count--;
+            test_count++;
+            while (test_count > capacity) {
+                runHandTest();
+            }
+        }
+        while (hot_count > capacity - cold_target) {
+            runHandHot();
+        }
+    }
+
+    void runHandHot() {
+        Page* page = hand_hot;
+        hand_hot = page->next;
+        if (page->type == HOT) {
+            if (page->referenced.load(std::memory_order_relaxed)) {
+                page->referenced.store(false, std::memory_order_relaxed);
+            } else {
+                page->type = COLD;
+                hot_count--;
+                cold_count++;
+            }
+        } else if (page->type == TEST) {
+            // hand_hot经过的测试页已超出测试期
+            test_count--;
+            if (cold_target > min_cold) {
+                cold_target--;
+            }
+            remove(page);
+        }
+    }
+
+    void runHandTest() {
+        Page* page = hand_test;
+        hand_test = page->next;
+        if (page->type == TEST) {
+            // 测试期内未被访问，说明冷页空间过大
+            test_count--;
+            if (cold_target > min_cold) {
+                cold_target--;
+            }
+            remove(page);
+        }
+    }
+
+    // 为一个新的常驻页腾出空间
+    void evict() {
+        while (hot_count + cold_count >= capacity) {
+            runHandCold();
+        }
+    }
+
+    void insert(const std::string& key, const T& value, PageType type) {
+        evict();
+        Page* page = new Page(key, value, type);
+        link(page);
+        index[key] = page;
+        if (type == HOT) {
+            hot_count++;
+        } else {
+            cold_count++;
+        }
+    }
+
+public:
+    explicit ClockProCache(size_t cap)
+        : hand_hot(nullptr), hand_cold(nullptr), hand_test(nullptr), capacity(cap), cold_target(cap),
+          min_cold(std::max(cap / 10, size_t(1))), hot_count(0), cold_count(0), test_count(0) {}
+
+    ClockProCache(const ClockProCache&) = delete;
+    ClockProCache& operator=(const ClockProCache&) = delete;
+
+    ~ClockProCache() {
+        while (hand_hot) {
+            remove(hand_hot);
+        }
+    }
+
+    bool get(const std::string& key, T& value) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end() || it->second->type == TEST) {
+            return false;
+        }
+        Page* page = it->second;
+        value = page->value;
+        page->referenced.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    void put(const std::string& key, const T& value) {
+        if (capacity == 0) {
+            return;
+        }
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            insert(key, value, COLD);
+            return;
+        }
+
+        Page* page = it->second;
+        if (page->type != TEST) {
+            // 更新常驻页的值
+            page->value = value;
+            page->referenced.store(true, std::memory_order_relaxed);
+            return;
+        }
+
+        // 测试页命中：冷页目标容量加一，页面作为热页重新载入
+        if (cold_target < capacity) {
+            cold_target++;
+        }
+        test_count--;
+        remove(page);
+        insert(key, value, HOT);
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return hot_count + cold_count;
+    }
+};
@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+#include "FlatHashMap.h"
+#include "KeyCodec.h"
+
+// 本地磁盘上的日志结构二级缓存
+// 写入的条目追加到当前段文件的末尾(先进入写缓冲区，满1MB时一次写出)，段写满segment_size后开始新的段；
+// 段数超过max_segments时删除最老的段文件，段内的条目全部失效(段级FIFO)，不做压缩整理。
+// 内存中的索引只保存键的64位哈希和记录位置(段号、偏移、长度)，每个条目约32字节，不保存键；
+// 读取时用pread读出整条记录，核对键和校验和。不同键哈希冲突时后写入的覆盖前一个。
+// 写入同一个键时旧记录成为垃圾，随所在段一起回收。不是线程安全的。
+class DiskTier {
+private:
+    static const size_t kWriteBufferSize = 1 << 20;
+
+    struct RecordHeader {
+        uint32_t key_len;
+        uint32_t value_len;
+        uint64_t checksum;  // 键和值的校验和
+    };
+
+    struct Location {
+        uint32_t segment;
+        uint32_t length;    // 整条记录的字节数
+        uint64_t offset;
+    };
+
+    struct Segment {
+        uint32_t id;
+        int fd;
+        uint64_t size;                 // 已追加的字节数(包括写缓冲区中的)
+        std::vector<uint64_t> hashes;  // 写入这个段的键，删除段时用来清理索引
+    };
+
+    std::string directory;
+    uint64_t segment_size;
+    size_t max_segments;
+
+    std::deque<Segment> segments;  // 最老的在前，最后一个是当前写入的段
+    uint32_t next_segment;
+    std::string write_buffer;      // 当前段尚未写出的尾部
+    uint64_t buffer_offset;        // 写缓冲区在当前段中的起始偏移
+    FlatHashMap<uint64_t, Location> index;
+    std::string read_buffer;
+
+    uint64_t bytes_written;
+    uint64_t disk_reads;
+    uint64_t segments_dropped;
+    bool failed;
+
+    std::string segmentPath(uint32_t id) const {
+        return directory + "/segment_" + std::to_string(id) + ".log";
+    }
+
+    bool flush() {
+        if (write_buffer.empty() || segments.empty()) {
+            return true;
+        }
+        Segment& active = segments.back();
+        const char* data = write_buffer.data();
+        size_t remaining = write_buffer.size();
+        uint64_t offset = buffer_offset;
+        while (remaining > 0) {
+            ssize_t written = pwrite(active.fd, data, remaining, offset);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                std::cerr << "Write " << segmentPath(active.id) << " failed: " << std::strerror(errno) << std::endl;
+                failed = true;
+                return false;
+            }
+            data += written;
+            remaining -= written;
+            offset += written;
+        }
+        buffer_offset = offset;
+        write_buffer.clear();
+        return true;
+    }
+
+    bool openSegment() {
+        if (!flush()) {
+            // 当前段的尾部写不出去，丢弃写缓冲区。指向这部分的索引项在readRecord中按越界处理，读取失败
+            write_buffer.clear();
+            return false;
+        }
+        Segment segment{next_segment++, -1, 0, {}};
+        segment.fd = ::open(segmentPath(segment.id).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (segment.fd < 0) {
+            std::cerr << "Cannot create " << segmentPath(segment.id) << ": " << std::strerror(errno) << std::endl;
+            failed = true;
+            return false;
+        }
+        segments.push_back(std::move(segment));
+        buffer_offset = 0;
+        while (segments.size() > max_segments) {
+            dropOldest();
+        }
+        return true;
+    }
+
+    // 删除最老的段，指向它的索引项全部失效
+    void dropOldest() {
+        Segment& oldest = segments.front();
+        for (uint64_t hash : oldest.hashes) {
+            auto it = index.find(hash);
+            if (it != index.end() && it->second.segment == oldest.id) {
+                index.erase(it);
+            }
+        }
+        ::close(oldest.fd);
+        ::unlink(segmentPath(oldest.id).c_str());
+        segments.pop_front();
+        segments_dropped++;
+    }
+
+    const Segment* findSegment(uint32_t id) const {
+        if (segments.empty() || id < segments.front().id) {
+            return nullptr;
+        }
+        size_t position = id - segments.front().id;
+        return position < segments.size() ? &segments[position] : nullptr;
+    }
+
+    // 读出一条记录：仍在写缓冲区中的直接拷贝，否则pread
+    bool readRecord(const Location& location, std::string& out) {
+        const Segment* segment = findSegment(location.segment);
+        if (!segment) {
+            return false;
+        }
+        out.resize(location.length);
+        if (segment == &segments.back() && location.offset >= buffer_offset) {
+            if (location.offset + location.length > buffer_offset + write_buffer.size()) {
+                return false;
+            }
+            std::memcpy(&out[0], write_buffer.data() + (location.offset - buffer_offset), location.length);
+            return true;
+        }
+        size_t done = 0;
+        while (done < location.length) {
+            ssize_t n = pread(segment->fd, &out[done], location.length - done, location.offset + done);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            done += n;
+        }
+        disk_reads++;
+        return true;
+    }
+
+public:
+    // directory必须已存在；容量上限约为segment_bytes * segments
+    DiskTier(const std::string& dir, uint64_t segment_bytes = 64 << 20, size_t segment_count = 16)
+        : directory(dir), segment_size(segment_bytes), max_segments(std::max<size_t>(segment_count, 1)),
+          next_segment(0), buffer_offset(0), bytes_written(0), disk_reads(0), segments_dropped(0), failed(false) {
+        write_buffer.reserve(kWriteBufferSize);
+        openSegment();
+    }
+
+    ~DiskTier() {
+        while (!segments.empty()) {
+            ::close(segments.front().fd);
+            ::unlink(segmentPath(segments.front().id).c_str());
+            segments.pop_front();
+        }
+    }
+
+    DiskTier(const DiskTier&) = delete;
+    DiskTier& operator=(const DiskTier&) = delete;
+
+    // 追加一个条目，覆盖这个键之前的记录
+    template<typename T>
+    bool put(std::string_view key, const T& value) {
+        if (failed) {
+            return false;
+        }
+        std::string encoded;
+        KeyCodec::encodeValue(value, encoded);
+        RecordHeader header{static_cast<uint32_t>(key.size()), static_cast<uint32_t>(encoded.size()), 0};
+        uint64_t key_checksum = KeyCodec::checksum(key.data(), key.size());
+        header.checksum = KeyCodec::checksum(encoded.data(), encoded.size(), key_checksum);
+        uint64_t length = sizeof(header) + key.size() + encoded.size();
+        if (segments.back().size + length > segment_size && segments.back().size > 0 && !openSegment()) {
+            return false;
+        }
+
+        Segment& active = segments.back();
+        uint64_t hash = KeyCodec::hashKey(key);
+        index[hash] = Location{active.id, static_cast<uint32_t>(length), active.size};
+        active.hashes.push_back(hash);
+        active.size += length;
+        bytes_written += length;
+        write_buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        write_buffer.append(key.data(), key.size());
+        write_buffer.append(encoded);
+        return write_buffer.size() < kWriteBufferSize || flush();
+    }
+
+    template<typename T>
+    bool get(std::string_view key, T& value) {
+        auto it = index.find(KeyCodec::hashKey(key));
+        if (it == index.end() || !readRecord(it->second, read_buffer)) {
+            return false;
+        }
+        RecordHeader header;
+        std::memcpy(&header, read_buffer.data(), sizeof(header));
+        if (sizeof(header) + header.key_len + header.value_len != read_buffer.size()) {
+            return false;
+        }
+        std::string_view stored_key(read_buffer.data() + sizeof(header), header.key_len);
+        std::string_view bytes(stored_key.data() + header.key_len, header.value_len);
+        if (stored_key != key || KeyCodec::checksum(bytes.data(), bytes.size(),
+                KeyCodec::checksum(stored_key.data(), stored_key.size())) != header.checksum) {
+            return false;
+        }
+        return KeyCodec::decodeValue(bytes, value);
+    }
+
+    // 从索引中删除键，磁盘空间随所在段回收
+    bool erase(std::string_view key) {
+        auto it = index.find(KeyCodec::hashKey(key));
+        if (it == index.end()) {
+            return false;
+        }
+        index.erase(it);
+        return true;
+    }
+
+    // 索引中的条目数
+    size_t size() const {
+        return index.size();
+    }
+
+    // 仍保留的段占用的磁盘字节数(包括被覆盖和删除的记录)
+    uint64_t diskBytes() const {
+        uint64_t total = 0;
+        for (const Segment& segment : segments) {
+            total += segment.size;
+        }
+        return total;
+    }
+
+    uint64_t bytesWritten() const {
+        return bytes_written;
+    }
+
+    // 通过pread读取的次数(不包括从写缓冲区读取)
+    uint64_t diskReads() const {
+        return disk_reads;
+    }
+
+    uint64_t segmentsDropped() const {
+        return segments_dropped;
+    }
+};
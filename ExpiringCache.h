@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "Cache.h"
+#include "CacheStats.h"
+#include "TimingWheel.h"
+
+enum class ExpirePolicy {
+    AfterWrite,   // 写入后经过TTL过期
+    AfterAccess   // 最后一次读写后经过TTL过期
+};
+
+// ExpiringCache的过期策略：与TtlExpiry一样，节点本身就是时间轮的定时器，
+// 另外在节点中记录条目自己的TTL(0表示永不过期)，AfterAccess时命中重新计时，并统计因过期删除的条目数
+struct EntryExpiry {
+    struct Stamp : TimingWheel::Timer {
+        uint64_t ttl = 0;  // 单位ms
+    };
+
+    uint64_t default_ttl;
+    uint64_t next_ttl;  // 下一次写入使用的TTL，由ExpiringCache::put设置
+    ExpirePolicy policy;
+    uint64_t start_ms;
+    uint64_t now_ms;    // 最近一次读到的时钟(相对start_ms)，也是时间轮的时间单位
+    unsigned interval;
+    unsigned ops;
+    size_t expired_count;
+    std::unique_ptr<TimingWheel> wheel;
+
+    explicit EntryExpiry(std::chrono::milliseconds ttl = std::chrono::seconds(60),
+                         ExpirePolicy expire_policy = ExpirePolicy::AfterWrite, unsigned clock_interval = 64)
+        : default_ttl(ttl.count()), next_ttl(ttl.count()), policy(expire_policy), start_ms(coarseClockMs()),
+          now_ms(0), interval(clock_interval == 0 ? 1 : clock_interval), ops(0), expired_count(0),
+          wheel(new TimingWheel()) {}
+
+    template<typename Callback>
+    void tick(Callback on_expire) {
+        if (++ops >= interval) {
+            advance(on_expire);
+        } else {
+            now_ms = coarseClockMs() - start_ms;
+        }
+    }
+
+    template<typename Callback>
+    void advance(Callback on_expire) {
+        now_ms = coarseClockMs() - start_ms;
+        ops = 0;
+        wheel->advance(now_ms, [&on_expire](TimingWheel::Timer* timer) {
+            on_expire(static_cast<Stamp*>(timer));
+        });
+    }
+
+    void stamp(Stamp& s) {
+        s.ttl = next_ttl;
+        if (s.ttl == 0) {
+            wheel->cancel(&s);
+        } else {
+            wheel->schedule(&s, now_ms + s.ttl);
+        }
+    }
+
+    void touch(Stamp& s) {
+        if (policy == ExpirePolicy::AfterAccess && s.scheduled()) {
+            wheel->schedule(&s, now_ms + s.ttl);
+        }
+    }
+
+    bool expired(const Stamp& s) const {
+        return s.scheduled() && now_ms >= s.deadline;
+    }
+
+    void onExpire(Stamp&) {
+        expired_count++;
+    }
+
+    void release(Stamp& s) {
+        wheel->cancel(&s);
+    }
+};
+
+// 带过期时间的缓存包装，可包装FIFO/LRU/LFU/ARC，底层缓存换用EntryExpiry(见WithExpiry)
+// 每个键可以单独指定TTL，未指定时使用默认TTL，TTL为0表示永不过期。
+// 定时器和TTL嵌入底层缓存的节点，命中只查一次索引。读取时用粗粒度时钟(coarseClockMs，几纳秒，
+// 不调用steady_clock::now())核对节点的到期时间，已到期的条目立即删除并按未命中处理，
+// 因此过期条目最多晚一个时钟中断周期(1~4ms)失效，与访问频率无关。
+// 分层时间轮只负责回收：每clock_interval次操作推进一次，把到期但没有再被读到的条目从底层缓存删除，不扫描缓存；
+// 访问稀疏时可以定期调用advanceClock()释放内存。条目被淘汰、删除或写入被拒绝时节点连同定时器一起释放。
+template<typename CacheType>
+class ExpiringCache {
+public:
+    typedef std::chrono::milliseconds Duration;
+
+private:
+    typename WithExpiry<CacheType, EntryExpiry>::type cache;
+
+public:
+    // 额外参数(如Weigher)原样传给底层缓存的构造函数
+    template<typename... Args>
+    ExpiringCache(size_t cap, Duration ttl, ExpirePolicy expire_policy = ExpirePolicy::AfterWrite,
+                  unsigned interval = 64, const Args&... args)
+        : cache(cap, args...) {
+        cache.expiryPolicy() = EntryExpiry(ttl, expire_policy, interval);
+    }
+
+    ExpiringCache(const ExpiringCache&) = delete;
+    ExpiringCache& operator=(const ExpiringCache&) = delete;
+
+    // 设置淘汰回调，条目被底层策略淘汰之前调用，因过期删除时不调用
+    template<typename Listener>
+    void setEvictionListener(Listener listener) {
+        cache.setEvictionListener(listener);
+    }
+
+    // 读取时钟并删除所有到期的条目
+    void advanceClock() {
+        cache.advanceClock();
+    }
+
+    template<typename T>
+    bool get(std::string_view key, T& value) {
+        return cache.get(key, value);
+    }
+
+    // 返回值句柄，未命中或已过期时返回空句柄
+    auto get(std::string_view key) {
+        return cache.get(key);
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        cache.put(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    // 使用单独的TTL写入
+    template<typename K, typename V>
+    void put(K&& key, V&& value, Duration ttl) {
+        EntryExpiry& expiry = cache.expiryPolicy();
+        expiry.next_ttl = ttl.count();
+        cache.put(std::forward<K>(key), std::forward<V>(value));
+        expiry.next_ttl = expiry.default_ttl;
+    }
+
+    bool erase(std::string_view key) {
+        return cache.erase(key);
+    }
+
+    size_t size() const {
+        return cache.size();
+    }
+
+    // 因过期被删除的条目数
+    size_t expiredCount() const {
+        return cache.expiryPolicy().expired_count;
+    }
+
+    // 底层缓存的统计，附带因过期删除的条目数
+    CacheStatsSnapshot stats() const {
+        CacheStatsSnapshot s = cache.stats();
+        s.gauges.emplace_back("expired_entries", static_cast<double>(expiredCount()));
+        return s;
+    }
+
+    // 时间轮中的定时器数
+    size_t timerCount() const {
+        return cache.expiryPolicy().wheel->size();
+    }
+};
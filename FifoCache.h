@@ -1,52 +1,15 @@
 #pragma once
 
-#include <unordered_map>
-#include <list>
-#include <memory>
+#include "Cache.h"
 #include "CachePolicy.h"
 
 // FIFO缓存实现
-template<typename T>
-class FIFOCache {
-private:
-    std::unordered_map<std::string, std::shared_ptr<CacheItem<T>>> cache_map;
-    std::list<std::shared_ptr<CacheItem<T>>> cache_list;
-    size_t capacity;
-
+// HandleCache对Cache<std::string, ..., FifoEviction>的适配，淘汰逻辑见Cache.h中的FifoEviction。
+// capacity是权重上限：默认每个条目权重为1(即条目数)，使用ByteWeigher时为字节预算
+template<typename T, typename Weigher = UnitWeigher, typename Expiry = NoExpiry>
+class FIFOCache : public HandleCache<T, FifoEviction, Weigher, Expiry> {
 public:
-    explicit FIFOCache(size_t cap) : capacity(cap) {}
-    
-    bool get(const std::string& key, T& value) {
-        auto it = cache_map.find(key);
-        if (it != cache_map.end()) {
-            value = it->second->value;
-            return true;
-        }
-        return false;
-    }
-    
-    void put(const std::string& key, const T& value) {
-        auto it = cache_map.find(key);
-        if (it != cache_map.end()) {
-            // 更新值
-            it->second->value = value;
-            return;
-        }
-        
-        // 添加新元素
-        if (cache_map.size() >= capacity) {
-            // 移除最老的元素
-            auto oldest = cache_list.front();
-            cache_list.pop_front();
-            cache_map.erase(oldest->key);
-        }
-        
-        auto item = std::make_shared<CacheItem<T>>(key, value);
-        cache_list.push_back(item);
-        cache_map[key] = item;
-    }
-    
-    size_t size() const {
-        return cache_map.size();
-    }
-};
\ No newline at end of file
+    static constexpr const char* kPolicyName = "FIFO";
+
+    using HandleCache<T, FifoEviction, Weigher, Expiry>::HandleCache;
+};
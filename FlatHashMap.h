@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 默认哈希函数。字符串键支持异构查找：可以直接用std::string_view或const char*查找，
+// 不必为了查找构造临时的std::string(std::hash<std::string_view>与std::hash<std::string>结果相同)
+template<typename K>
+struct FlatHash : std::hash<K> {};
+
+template<>
+struct FlatHash<std::string> {
+    typedef void is_transparent;
+
+    size_t operator()(std::string_view key) const {
+        return std::hash<std::string_view>()(key);
+    }
+};
+
+// 开放寻址哈希表，用作各缓存策略的键索引
+// 槽位按16个一组，每个槽位有一个控制字节：空、已删除，或者哈希值低7位(tag)。
+// 查找时一次比较一组16个tag(SSE2)，只有tag相同的槽位才比较完整哈希和键。
+// 槽位中保存完整哈希值，扩容时直接按保存的哈希重新放置，不再对键重新计算哈希。
+template<typename K, typename V, typename Hash = FlatHash<K>, typename KeyEqual = std::equal_to<>>
+class FlatHashMap {
+public:
+    typedef std::pair<K, V> value_type;
+
+private:
+    static const size_t kGroupSize = 16;
+    static const int8_t kEmpty = -128;   // 0x80
+    static const int8_t kDeleted = -2;   // 0xFE
+
+    struct Slot {
+        size_t hash;
+        value_type kv;
+    };
+
+    int8_t* ctrl;
+    Slot* slots;
+    size_t slot_count;     // 总槽位数，0或16的2的幂倍
+    size_t element_count;
+    size_t deleted_count;
+    Hash hasher;
+    KeyEqual key_equal;
+
+    static int8_t tagOf(size_t hash) {
+        return static_cast<int8_t>(hash & 0x7F);
+    }
+
+    size_t groupMask() const {
+        return slot_count / kGroupSize - 1;
+    }
+
+    // 返回一组中控制字节等于tag的槽位掩码
+    static uint32_t matchTag(const int8_t* group, int8_t tag) {
+#if defined(__SSE2__)
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_bytes, _mm_set1_epi8(tag))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; i++) {
+            if (group[i] == tag) {
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+#endif
+    }
+
+    // 返回一组中空槽或已删除槽(控制字节最高位为1)的掩码
+    static uint32_t matchEmptyOrDeleted(const int8_t* group) {
+#if defined(__SSE2__)
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_bytes));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < kGroupSize; i++) {
+            if (group[i] < 0) {
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+#endif
+    }
+
+    static int lowestBit(uint32_t mask) {
+        return __builtin_ctz(mask);
+    }
+
+    // 在探测序列中查找键，返回槽位下标，不存在时返回slot_count
+    template<typename LookupKey>
+    size_t findIndex(const LookupKey& key, size_t hash) const {
+        if (slot_count == 0) {
+            return slot_count;
+        }
+        int8_t tag = tagOf(hash);
+        size_t mask = groupMask();
+        size_t group = (hash >> 7) & mask;
+        for (size_t step = 1; ; step++) {
+            const int8_t* group_ctrl = ctrl + group * kGroupSize;
+            uint32_t matches = matchTag(group_ctrl, tag);
+            while (matches) {
+                size_t index = group * kGroupSize + lowestBit(matches);
+                if (slots[index].hash == hash && key_equal(slots[index].kv.first, key)) {
+                    return index;
+                }
+                matches &= matches - 1;
+            }
+            // 组内有空槽说明探测序列到此结束
+            if (matchTag(group_ctrl, kEmpty)) {
+                return slot_count;
+            }
+            if (step > mask) {
+                return slot_count;
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    // 找到哈希值对应的第一个可写入槽位(空或已删除)
+    size_t findInsertIndex(size_t hash) const {
+        size_t mask = groupMask();
+        size_t group = (hash >> 7) & mask;
+        for (size_t step = 1; ; step++) {
+            uint32_t free_slots = matchEmptyOrDeleted(ctrl + group * kGroupSize);
+            if (free_slots) {
+                return group * kGroupSize + lowestBit(free_slots);
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    void rehash(size_t new_slot_count) {
+        int8_t* old_ctrl = ctrl;
+        Slot* old_slots = slots;
+        size_t old_slot_count = slot_count;
+
+        ctrl = new int8_t[new_slot_count];
+        std::memset(ctrl, kEmpty, new_slot_count);
+        slots = static_cast<Slot*>(::operator new(sizeof(Slot) * new_slot_count));
+        slot_count = new_slot_count;
+        deleted_count = 0;
+
+        for (size_t i = 0; i < old_slot_count; i++) {
+            if (old_ctrl[i] >= 0) {
+                size_t index = findInsertIndex(old_slots[i].hash);
+                ctrl[index] = old_ctrl[i];
+                new (&slots[index]) Slot{old_slots[i].hash, std::move(old_slots[i].kv)};
+                old_slots[i].~Slot();
+            }
+        }
+
+        delete[] old_ctrl;
+        ::operator delete(old_slots);
+    }
+
+    // 插入前保证装载率(含已删除槽)不超过7/8
+    void reserveForInsert() {
+        if (slot_count == 0) {
+            rehash(kGroupSize);
+        } else if ((element_count + deleted_count + 1) * 8 > slot_count * 7) {
+            // 已删除槽较多时原地整理，否则扩容一倍
+            size_t new_slot_count = (element_count + 1) * 8 > slot_count * 3 ? slot_count * 2 : slot_count;
+            rehash(new_slot_count);
+        }
+    }
+
+    template<typename KeyArg>
+    size_t insertNew(KeyArg&& key, size_t hash) {
+        reserveForInsert();
+        size_t index = findInsertIndex(hash);
+        if (ctrl[index] == kDeleted) {
+            deleted_count--;
+        }
+        ctrl[index] = tagOf(hash);
+        new (&slots[index]) Slot{hash, value_type(std::forward<KeyArg>(key), V())};
+        element_count++;
+        return index;
+    }
+
+    void eraseIndex(size_t index) {
+        slots[index].~Slot();
+        element_count--;
+        // 所在组仍有空槽时，没有键会越过这一组继续探测，可以直接标记为空
+        size_t group_start = index / kGroupSize * kGroupSize;
+        if (matchTag(ctrl + group_start, kEmpty)) {
+            ctrl[index] = kEmpty;
+        } else {
+            ctrl[index] = kDeleted;
+            deleted_count++;
+        }
+    }
+
+    void destroyAll() {
+        for (size_t i = 0; i < slot_count; i++) {
+            if (ctrl[i] >= 0) {
+                slots[i].~Slot();
+            }
+        }
+        delete[] ctrl;
+        ::operator delete(slots);
+    }
+
+public:
+    class iterator {
+    private:
+        friend class FlatHashMap;
+        const FlatHashMap* map;
+        size_t index;
+
+        void skipEmpty() {
+            while (index < map->slot_count && map->ctrl[index] < 0) {
+                index++;
+            }
+        }
+
+    public:
+        iterator(const FlatHashMap* m, size_t i) : map(m), index(i) {}
+
+        value_type& operator*() const {
+            return map->slots[index].kv;
+        }
+
+        value_type* operator->() const {
+            return &map->slots[index].kv;
+        }
+
+        iterator& operator++() {
+            index++;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return index != other.index;
+        }
+    };
+
+    FlatHashMap() : ctrl(nullptr), slots(nullptr), slot_count(0), element_count(0), deleted_count(0) {}
+
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    ~FlatHashMap() {
+        destroyAll();
+    }
+
+    iterator begin() const {
+        iterator it(this, 0);
+        it.skipEmpty();
+        return it;
+    }
+
+    iterator end() const {
+        return iterator(this, slot_count);
+    }
+
+    // 查找、插入和删除都接受任何可与K比较且可哈希的键类型
+    template<typename LookupKey>
+    iterator find(const LookupKey& key) const {
+        return iterator(this, findIndex(key, hasher(key)));
+    }
+
+    template<typename LookupKey>
+    V& operator[](LookupKey&& key) {
+        size_t hash = hasher(key);
+        size_t index = findIndex(key, hash);
+        if (index == slot_count) {
+            index = insertNew(K(std::forward<LookupKey>(key)), hash);
+        }
+        return slots[index].kv.second;
+    }
+
+    template<typename LookupKey>
+    size_t erase(const LookupKey& key) {
+        size_t index = findIndex(key, hasher(key));
+        if (index == slot_count) {
+            return 0;
+        }
+        eraseIndex(index);
+        return 1;
+    }
+
+    void erase(iterator it) {
+        eraseIndex(it.index);
+    }
+
+    void clear() {
+        destroyAll();
+        ctrl = nullptr;
+        slots = nullptr;
+        slot_count = 0;
+        element_count = 0;
+        deleted_count = 0;
+    }
+
+    size_t size() const {
+        return element_count;
+    }
+
+    bool empty() const {
+        return element_count == 0;
+    }
+};
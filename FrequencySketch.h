@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 4位计数器的Count-Min Sketch，用于估计键的访问频率
+// 每个64位字存放16个4位计数器，每个键映射到4个计数器，估计值取其中最小者(上限15)。
+// 累计增加次数达到采样窗口(10倍容量)后，所有计数器减半，使旧的热点逐渐老化。
+class FrequencySketch {
+private:
+    static const int kDepth = 4;
+
+    std::vector<uint64_t> table;
+    size_t table_mask;
+    size_t sample_size;
+    size_t additions;
+    std::hash<std::string> hasher;
+
+    static uint64_t mix(uint64_t h, int i) {
+        static const uint64_t kSeeds[kDepth] = {
+            0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+        h = (h + kSeeds[i]) * kSeeds[i];
+        return h ^ (h >> 32);
+    }
+
+    void reset() {
+        for (uint64_t& word : table) {
+            word = (word >> 1) & 0x7777777777777777ULL;
+        }
+        additions /= 2;
+    }
+
+public:
+    explicit FrequencySketch(size_t capacity) : additions(0) {
+        size_t words = 16;
+        while (words < capacity) {
+            words <<= 1;
+        }
+        table.assign(words, 0);
+        table_mask = words - 1;
+        sample_size = 10 * std::max(capacity, size_t(1));
+    }
+
+    size_t hashOf(const std::string& key) const {
+        return hasher(key);
+    }
+
+    // 估计访问频率(0~15)
+    int frequency(size_t hash) const {
+        int result = 15;
+        for (int i = 0; i < kDepth; i++) {
+            uint64_t h = mix(hash, i);
+            int shift = static_cast<int>((h >> 58) & 15) << 2;
+            int count = static_cast<int>((table[h & table_mask] >> shift) & 15);
+            result = std::min(result, count);
+        }
+        return result;
+    }
+
+    int frequency(const std::string& key) const {
+        return frequency(hashOf(key));
+    }
+
+    void increment(size_t hash) {
+        bool added = false;
+        for (int i = 0; i < kDepth; i++) {
+            uint64_t h = mix(hash, i);
+            int shift = static_cast<int>((h >> 58) & 15) << 2;
+            uint64_t& word = table[h & table_mask];
+            if (((word >> shift) & 15) < 15) {
+                word += 1ULL << shift;
+                added = true;
+            }
+        }
+        if (added && ++additions >= sample_size) {
+            reset();
+        }
+    }
+
+    void increment(const std::string& key) {
+        increment(hashOf(key));
+    }
+};
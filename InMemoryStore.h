@@ -0,0 +1,187 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BackingStore.h"
+#include "FlatHashMap.h"
+
+// 后端延迟模型：每次调用的基础延迟(固定或对数正态)，以一定概率叠加一次长尾尖刺，
+// 批量调用另外按行数增加per_row延迟
+struct LatencyModel {
+    enum Kind { None, Fixed, LogNormal };
+
+    Kind kind = None;
+    std::chrono::microseconds base{0};   // Fixed为固定延迟，LogNormal为中位数
+    double sigma = 0;                    // LogNormal的对数标准差
+    double spike_probability = 0;
+    std::chrono::microseconds spike{0};
+    std::chrono::microseconds per_row{0};
+
+    static LatencyModel fixed(std::chrono::microseconds latency) {
+        LatencyModel model;
+        model.kind = Fixed;
+        model.base = latency;
+        return model;
+    }
+
+    static LatencyModel logNormal(std::chrono::microseconds median, double sigma) {
+        LatencyModel model;
+        model.kind = LogNormal;
+        model.base = median;
+        model.sigma = sigma;
+        return model;
+    }
+
+    LatencyModel withSpikes(double probability, std::chrono::microseconds latency) const {
+        LatencyModel model = *this;
+        model.spike_probability = probability;
+        model.spike = latency;
+        return model;
+    }
+
+    LatencyModel withPerRow(std::chrono::microseconds latency) const {
+        LatencyModel model = *this;
+        model.per_row = latency;
+        return model;
+    }
+
+    std::chrono::microseconds sample(std::mt19937& gen, size_t rows) const {
+        double us = 0;
+        if (kind == Fixed) {
+            us = static_cast<double>(base.count());
+        } else if (kind == LogNormal) {
+            std::lognormal_distribution<double> dist(std::log(static_cast<double>(base.count())), sigma);
+            us = dist(gen);
+        }
+        if (spike_probability > 0 && std::uniform_real_distribution<double>(0, 1)(gen) < spike_probability) {
+            us += static_cast<double>(spike.count());
+        }
+        us += static_cast<double>(per_row.count()) * rows;
+        return std::chrono::microseconds(static_cast<long long>(us));
+    }
+};
+
+// 内存中的后端，用于在没有MySQL的机器上测量未命中代价和加载策略
+// 每次调用按LatencyModel等待，最多max_concurrent个调用同时进行，其余排队(模拟连接数或服务端并发上限)。
+// 延迟由固定种子的随机数生成，结果可复现。线程安全。
+class InMemoryStore : public BackingStore {
+private:
+    FlatHashMap<std::string, std::string> data;
+    std::shared_mutex data_mutex;
+
+    LatencyModel latency;
+    std::mutex rng_mutex;
+    std::mt19937 gen;
+
+    size_t max_concurrent;
+    size_t active_calls;
+    std::mutex slot_mutex;
+    std::condition_variable slot_free;
+
+    size_t call_count;
+    size_t row_count;
+
+    // 占用一个并发名额并等待模拟延迟
+    void simulateCall(size_t rows) {
+        std::chrono::microseconds delay;
+        {
+            std::lock_guard<std::mutex> lock(rng_mutex);
+            delay = latency.sample(gen, rows);
+            call_count++;
+            row_count += rows;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(slot_mutex);
+            slot_free.wait(lock, [this]() { return active_calls < max_concurrent; });
+            active_calls++;
+        }
+        wait(delay);
+        {
+            std::lock_guard<std::mutex> lock(slot_mutex);
+            active_calls--;
+        }
+        slot_free.notify_one();
+    }
+
+    // sleep_for的误差在几十微秒量级，最后一段改为自旋
+    static void wait(std::chrono::microseconds delay) {
+        auto deadline = std::chrono::steady_clock::now() + delay;
+        const std::chrono::microseconds kSpinThreshold(100);
+        if (delay > kSpinThreshold) {
+            std::this_thread::sleep_for(delay - kSpinThreshold);
+        }
+        while (std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    explicit InMemoryStore(LatencyModel model = LatencyModel(), size_t concurrency = 64, unsigned seed = 42)
+        : latency(model), gen(seed), max_concurrent(concurrency == 0 ? 1 : concurrency), active_calls(0),
+          call_count(0), row_count(0) {}
+
+    bool getData(const std::string& key, std::string& value) override {
+        simulateCall(1);
+        std::shared_lock<std::shared_mutex> lock(data_mutex);
+        auto it = data.find(key);
+        if (it == data.end()) {
+            return false;
+        }
+        value = it->second;
+        return true;
+    }
+
+    bool putData(const std::string& key, const std::string& value) override {
+        simulateCall(1);
+        std::unique_lock<std::shared_mutex> lock(data_mutex);
+        data[key] = value;
+        return true;
+    }
+
+    bool getDataBatch(const std::vector<std::string>& keys,
+                      std::vector<std::pair<std::string, std::string>>& rows) override {
+        simulateCall(keys.size());
+        std::shared_lock<std::shared_mutex> lock(data_mutex);
+        for (const std::string& key : keys) {
+            auto it = data.find(key);
+            if (it != data.end()) {
+                rows.emplace_back(key, it->second);
+            }
+        }
+        return true;
+    }
+
+    bool putDataBatch(const std::vector<std::pair<std::string, std::string>>& rows) override {
+        simulateCall(rows.size());
+        std::unique_lock<std::shared_mutex> lock(data_mutex);
+        for (const auto& row : rows) {
+            data[row.first] = row.second;
+        }
+        return true;
+    }
+
+    // 直接写入数据，不模拟延迟，用于准备测试数据
+    void load(const std::string& key, const std::string& value) {
+        std::unique_lock<std::shared_mutex> lock(data_mutex);
+        data[key] = value;
+    }
+
+    size_t callCount() {
+        std::lock_guard<std::mutex> lock(rng_mutex);
+        return call_count;
+    }
+
+    size_t rowCount() {
+        std::lock_guard<std::mutex> lock(rng_mutex);
+        return row_count;
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 键哈希、校验和与值编码，缺失率估计、自适应缓存、快照和磁盘层共用
+namespace KeyCodec {
+    // splitmix64的混合函数，输入的低位或高位分布不均时输出也均匀
+    inline uint64_t mix64(uint64_t h) {
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+        return h;
+    }
+
+    // 进程内使用的64位键哈希(不写入文件)：按值采样、磁盘层的内存索引
+    inline uint64_t hashKey(std::string_view key) {
+        return mix64(std::hash<std::string_view>()(key));
+    }
+
+    inline uint64_t hashKey(uint64_t key) {
+        return mix64(key);
+    }
+
+    // FNV-1a，与编译器和标准库无关，可以写入文件；h传入上一段的结果可以连续计算多段
+    inline uint64_t checksum(const void* data, size_t len, uint64_t h = 0xcbf29ce484222325ULL) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; i++) {
+            h ^= p[i];
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // 值的编码：std::string按原始字节，其他类型必须是可平凡复制的
+    inline void encodeValue(const std::string& value, std::string& out) {
+        out = value;
+    }
+
+    template<typename T>
+    void encodeValue(const T& value, std::string& out) {
+        static_assert(std::is_trivially_copyable<T>::value, "stored values must be std::string or trivially copyable");
+        out.assign(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    inline bool decodeValue(std::string_view bytes, std::string& value) {
+        value.assign(bytes.data(), bytes.size());
+        return true;
+    }
+
+    template<typename T>
+    bool decodeValue(std::string_view bytes, T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "stored values must be std::string or trivially copyable");
+        if (bytes.size() != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, bytes.data(), sizeof(T));
+        return true;
+    }
+}
@@ -1,74 +1,16 @@
 #pragma once
 
-#include <unordered_map>
-#include <list>
-#include <memory>
+#include "Cache.h"
 #include "CachePolicy.h"
 
 // LFU缓存实现
-template<typename T>
-class LFUCache {
-private:
-    std::unordered_map<std::string, T> cache_map;
-    std::unordered_map<std::string, int> frequency_map;
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point> access_time_map;
-    size_t capacity;
-
+// HandleCache对Cache<std::string, ..., LfuEviction>的适配，淘汰逻辑见Cache.h中的LfuEviction：
+// 按访问频率分桶，桶按频率串成有序链表，淘汰时直接取第一个桶的表头，get/put/erase/淘汰均为O(1)。
+// capacity是权重上限：默认每个条目权重为1(即条目数)，使用ByteWeigher时为字节预算
+template<typename T, typename Weigher = UnitWeigher, typename Expiry = NoExpiry>
+class LFUCache : public HandleCache<T, LfuEviction, Weigher, Expiry> {
 public:
-    explicit LFUCache(size_t cap) : capacity(cap) {}
-    
-    bool get(const std::string& key, T& value) {
-        auto it = cache_map.find(key);
-        if (it != cache_map.end()) {
-            value = it->second;
-            frequency_map[key]++;
-            access_time_map[key] = std::chrono::steady_clock::now();
-            return true;
-        }
-        return false;
-    }
-    
-    void put(const std::string& key, const T& value) {
-        auto it = cache_map.find(key);
-        if (it != cache_map.end()) {
-            // 更新值
-            it->second = value;
-            frequency_map[key]++;
-            access_time_map[key] = std::chrono::steady_clock::now();
-            return;
-        }
-        
-        // 添加新元素
-        if (cache_map.size() >= capacity) {
-            // 找到频率最低且最久未使用的元素
-            std::string evict_key;
-            int min_freq = std::numeric_limits<int>::max();
-            auto oldest_time = std::chrono::steady_clock::now();
-            
-            for (const auto& freq_pair : frequency_map) {
-                const std::string& k = freq_pair.first;
-                int freq = freq_pair.second;
-                
-                if (freq < min_freq || (freq == min_freq && access_time_map[k] < oldest_time)) {
-                    min_freq = freq;
-                    oldest_time = access_time_map[k];
-                    evict_key = k;
-                }
-            }
-            
-            // 移除选中的元素
-            cache_map.erase(evict_key);
-            frequency_map.erase(evict_key);
-            access_time_map.erase(evict_key);
-        }
-        
-        // 添加新元素
-        cache_map[key] = value;
-        frequency_map[key] = 1;
-        access_time_map[key] = std::chrono::steady_clock::now();
-    }
-    
-    size_t size() const {
-        return cache_map.size();
-    }
-};
\ No newline at end of file
+    static constexpr const char* kPolicyName = "LFU";
+
+    using HandleCache<T, LfuEviction, Weigher, Expiry>::HandleCache;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// 对数分桶的延迟直方图(HDR风格)
+// 按最高有效位分成若干段，每段再线性分成2^kSubBucketBits个子桶，相对误差不超过1/2^kSubBucketBits(约1.6%)。
+// 记录是O(1)的数组自增，不分配内存；每个线程用自己的直方图，结束后merge到一起。单位任意(通常为ns)。
+class LatencyHistogram {
+private:
+    static const int kSubBucketBits = 6;
+    static const uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+    static const size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    uint64_t max_value;
+    uint64_t sum;
+
+    static size_t indexOf(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - kSubBucketBits;
+        uint64_t top = value >> shift;  // [kSubBuckets, 2 * kSubBuckets)
+        return static_cast<size_t>((shift + 1) * kSubBuckets + (top - kSubBuckets));
+    }
+
+    // 桶中最大的值
+    static uint64_t highestEquivalent(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        int shift = static_cast<int>(index / kSubBuckets) - 1;
+        uint64_t top = index % kSubBuckets + kSubBuckets;
+        return ((top + 1) << shift) - 1;
+    }
+
+public:
+    LatencyHistogram() : counts(kBucketCount, 0), total(0), max_value(0), sum(0) {}
+
+    void record(uint64_t value) {
+        counts[indexOf(value)]++;
+        total++;
+        sum += value;
+        if (value > max_value) {
+            max_value = value;
+        }
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < kBucketCount; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        max_value = std::max(max_value, other.max_value);
+    }
+
+    void reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        max_value = 0;
+        sum = 0;
+    }
+
+    // 百分位数(0-100)，返回所在桶的上界，不超过最大值
+    uint64_t percentile(double p) const {
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * total));
+        target = std::max<uint64_t>(std::min(target, total), 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; i++) {
+            seen += counts[i];
+            if (seen >= target) {
+                return std::min(highestEquivalent(i), max_value);
+            }
+        }
+        return max_value;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    uint64_t max() const {
+        return max_value;
+    }
+
+    double mean() const {
+        return total ? static_cast<double>(sum) / total : 0.0;
+    }
+};
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "CacheStats.h"
+#include "FlatHashMap.h"
+#include "LRUCache.h"
+#include "ShardedCache.h"
+
+// 读穿透缓存：未命中时由缓存调用loader从后端(如MySQLDB::getData)读取并写入缓存
+// 同一个键的并发未命中只发起一次加载，其余线程等待同一个结果(single-flight)，
+// 避免热点键失效时大量线程同时查询数据库。
+// CacheType必须是线程安全的(ShardedCache、ClockCache等)；loader在不持有任何锁的情况下调用。
+// 后端不存在的键不会被缓存，下一次未命中会重新加载。
+template<typename T, typename CacheType = ShardedCache<LRUCache<T>>>
+class LoadingCache {
+public:
+    // 返回键是否存在，存在时写入value
+    typedef std::function<bool(const std::string& key, T& value)> Loader;
+    // 批量加载(如一条IN (...)查询)，把找到的(键, 值)追加到found，后端没有的键不返回
+    typedef std::function<bool(const std::vector<std::string>& keys, std::vector<std::pair<std::string, T>>& found)>
+        BatchLoader;
+
+private:
+    // 进行中的加载，结果为空表示后端没有这个键
+    typedef std::shared_future<std::shared_ptr<const T>> PendingLoad;
+
+    CacheType cache;
+    Loader loader;
+    BatchLoader batch_loader;
+    std::mutex pending_mutex;
+    FlatHashMap<std::string, PendingLoad> pending;
+    std::atomic<size_t> load_count;
+    std::atomic<size_t> batch_count;
+    std::atomic<size_t> coalesced_count;
+    CacheStats counters;  // 加载次数和耗时
+
+    void recordLoad(std::chrono::steady_clock::time_point start) {
+        counters.record(kLoads);
+        counters.record(kLoadNanos, std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    // 由发起加载的线程调用：加载、写入缓存、移除进行中的记录，最后唤醒等待者
+    std::shared_ptr<const T> load(const std::string& key, std::promise<std::shared_ptr<const T>>& promise) {
+        load_count++;
+        std::shared_ptr<const T> result;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            T value;
+            bool found = loader(key, value);
+            recordLoad(start);
+            if (found) {
+                result = std::make_shared<const T>(std::move(value));
+                cache.put(key, *result);
+            }
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                pending.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        // 先写缓存再移除记录，之后到达的线程一定能在缓存中命中
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            pending.erase(key);
+        }
+        promise.set_value(result);
+        return result;
+    }
+
+public:
+    // 额外参数原样传给CacheType的构造函数
+    template<typename... Args>
+    explicit LoadingCache(Loader l, const Args&... args)
+        : cache(args...), loader(std::move(l)), load_count(0), batch_count(0), coalesced_count(0) {}
+
+    // 设置批量加载函数后，getMany把所有未命中合并成一次加载，否则逐个调用loader
+    void setBatchLoader(BatchLoader l) {
+        batch_loader = std::move(l);
+    }
+
+    // 命中时直接返回；未命中时加载，或等待同一个键正在进行的加载
+    bool get(std::string_view key, T& value) {
+        if (cache.get(key, value)) {
+            return true;
+        }
+
+        std::promise<std::shared_ptr<const T>> promise;
+        PendingLoad waiting;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            auto it = pending.find(key);
+            if (it != pending.end()) {
+                waiting = it->second;
+            } else {
+                // 加锁后再查一次缓存：另一个线程可能刚完成加载并移除了记录
+                if (cache.get(key, value)) {
+                    return true;
+                }
+                pending[key] = promise.get_future().share();
+            }
+        }
+
+        std::shared_ptr<const T> result;
+        if (waiting.valid()) {
+            coalesced_count++;
+            result = waiting.get();
+        } else {
+            result = load(std::string(key), promise);
+        }
+        if (!result) {
+            return false;
+        }
+        value = *result;
+        return true;
+    }
+
+    // 批量读取，values[i]对应keys[i]，不存在的键为空，返回找到的个数
+    // 命中在本地返回；其余键中正在被其他线程加载的等待其结果，剩下的用一次批量加载取回并写入缓存。
+    // 这次批量加载也登记为进行中，期间其他线程对这些键的get会等待它而不是单独查询。
+    size_t getMany(const std::vector<std::string>& keys, std::vector<std::optional<T>>& values) {
+        values.assign(keys.size(), std::nullopt);
+        size_t found_count = 0;
+        std::vector<size_t> misses;
+        for (size_t i = 0; i < keys.size(); i++) {
+            T value;
+            if (cache.get(keys[i], value)) {
+                values[i] = std::move(value);
+                found_count++;
+            } else {
+                misses.push_back(i);
+            }
+        }
+        if (misses.empty()) {
+            return found_count;
+        }
+        if (!batch_loader) {
+            for (size_t i : misses) {
+                T value;
+                if (get(keys[i], value)) {
+                    values[i] = std::move(value);
+                    found_count++;
+                }
+            }
+            return found_count;
+        }
+
+        // 登记由本次批量加载负责的键(同一批中重复的键只登记一次)，其余的等待已有的加载
+        std::vector<std::pair<size_t, PendingLoad>> waiting;
+        std::vector<std::string> batch_keys;
+        std::vector<std::promise<std::shared_ptr<const T>>> promises;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex);
+            promises.reserve(misses.size());
+            for (size_t i : misses) {
+                auto it = pending.find(keys[i]);
+                if (it != pending.end()) {
+                    waiting.emplace_back(i, it->second);
+                    continue;
+                }
+                T value;
+                if (cache.get(keys[i], value)) {
+                    values[i] = std::move(value);
+                    found_count++;
+                    continue;
+                }
+                promises.emplace_back();
+                PendingLoad future = promises.back().get_future().share();
+                pending[keys[i]] = future;
+                batch_keys.push_back(keys[i]);
+                waiting.emplace_back(i, std::move(future));
+            }
+        }
+
+        if (!batch_keys.empty()) {
+            batch_count++;
+            load_count++;
+            std::vector<std::pair<std::string, T>> found;
+            bool ok = false;
+            auto start = std::chrono::steady_clock::now();
+            try {
+                ok = batch_loader(batch_keys, found);
+                recordLoad(start);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                for (size_t j = 0; j < batch_keys.size(); j++) {
+                    pending.erase(batch_keys[j]);
+                    promises[j].set_exception(std::current_exception());
+                }
+                throw;
+            }
+
+            FlatHashMap<std::string, std::shared_ptr<const T>> loaded;
+            if (ok) {
+                for (auto& row : found) {
+                    std::shared_ptr<const T> value = std::make_shared<const T>(std::move(row.second));
+                    cache.put(row.first, *value);
+                    loaded[std::move(row.first)] = std::move(value);
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex);
+                for (const std::string& key : batch_keys) {
+                    pending.erase(key);
+                }
+            }
+            for (size_t j = 0; j < batch_keys.size(); j++) {
+                auto it = loaded.find(batch_keys[j]);
+                promises[j].set_value(it != loaded.end() ? it->second : std::shared_ptr<const T>());
+            }
+        }
+
+        for (auto& entry : waiting) {
+            std::shared_ptr<const T> result = entry.second.get();
+            if (result) {
+                values[entry.first] = *result;
+                found_count++;
+            }
+        }
+        coalesced_count += waiting.size() - batch_keys.size();
+        return found_count;
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        cache.put(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    // 后端数据修改后使缓存失效
+    bool invalidate(std::string_view key) {
+        return cache.erase(key);
+    }
+
+    size_t size() {
+        return cache.size();
+    }
+
+    // 实际发起的后端加载次数(一次批量加载计为一次)
+    size_t loadCount() const {
+        return load_count.load();
+    }
+
+    // 其中批量加载的次数
+    size_t batchCount() const {
+        return batch_count.load();
+    }
+
+    // 底层缓存的统计加上加载次数和加载总耗时，要求CacheType提供stats()
+    CacheStatsSnapshot stats() {
+        CacheStatsSnapshot s = cache.stats();
+        s.merge(counters.snapshot());
+        return s;
+    }
+
+    // 等待其他线程的加载而省下的后端查询次数
+    size_t savedLoads() const {
+        return coalesced_count.load();
+    }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "FlatHashMap.h"
+#include "KeyCodec.h"
+
+// LRU缺失率曲线估计(固定内存的SHARDS)
+// 按键的哈希做空间采样：哈希值小于阈值的键才被跟踪，对它们计算重用距离(两次访问之间访问过的不同键数)，
+// 再除以采样率还原成全量的距离。容量为C的LRU命中当且仅当距离小于C，所以一次遍历得到所有容量的命中率。
+// 跟踪的键数超过sample_budget时降低阈值，丢弃哈希最大的键，已有的直方图按采样率的变化缩放，内存固定。
+// 距离用树状数组在最后访问时间上计数，时间槽用完时按访问顺序重新编号，均摊O(log n)。不是线程安全的。
+class ShardsEstimator {
+private:
+    size_t bucket_size;
+    size_t sample_budget;
+
+    uint64_t threshold;                              // 采样阈值，采样率为threshold / 2^64
+    FlatHashMap<uint64_t, uint32_t> last_slot;       // 跟踪的键 -> 最后一次访问的时间槽
+    std::set<uint64_t> tracked;                      // 跟踪的键，按哈希排序，用于淘汰最大者
+    std::vector<int> fenwick;                        // 每个时间槽是否是某个键的最后一次访问
+    std::vector<uint64_t> slot_owner;
+    uint32_t next_slot;
+
+    std::vector<double> histogram;                   // 按bucket_size分桶的距离，最后一个桶是超出最大容量的距离
+    double cold_misses;                              // 第一次访问
+    double sampled_refs;
+    uint64_t total_refs;
+
+    void fenwickAdd(uint32_t slot, int delta) {
+        for (size_t i = slot + 1; i < fenwick.size(); i += i & (~i + 1)) {
+            fenwick[i] += delta;
+        }
+    }
+
+    // 时间槽[0, slot]中的计数
+    int fenwickPrefix(uint32_t slot) const {
+        int sum = 0;
+        for (size_t i = slot + 1; i > 0; i -= i & (~i + 1)) {
+            sum += fenwick[i];
+        }
+        return sum;
+    }
+
+    // 只保留每个键的最后一次访问，按原顺序重新编号
+    void compact() {
+        std::vector<uint64_t> order;
+        order.reserve(tracked.size());
+        for (uint32_t slot = 0; slot < next_slot; slot++) {
+            auto it = last_slot.find(slot_owner[slot]);
+            if (it != last_slot.end() && it->second == slot) {
+                order.push_back(slot_owner[slot]);
+            }
+        }
+        std::fill(fenwick.begin(), fenwick.end(), 0);
+        next_slot = 0;
+        for (uint64_t key : order) {
+            last_slot[key] = next_slot;
+            slot_owner[next_slot] = key;
+            fenwickAdd(next_slot, 1);
+            next_slot++;
+        }
+    }
+
+    // 跟踪的键超过预算：降低阈值到最大的哈希，丢弃它，并按采样率的变化缩放已有计数
+    void shrink() {
+        uint64_t largest = *tracked.rbegin();
+        tracked.erase(std::prev(tracked.end()));
+        auto it = last_slot.find(largest);
+        fenwickAdd(it->second, -1);
+        last_slot.erase(it);
+
+        double scale = static_cast<double>(largest) / static_cast<double>(threshold);
+        threshold = largest;
+        for (double& count : histogram) {
+            count *= scale;
+        }
+        cold_misses *= scale;
+        sampled_refs *= scale;
+    }
+
+public:
+    // 估计容量1..max_cap(按条目数)的曲线，分成buckets段；budget为最多跟踪的键数
+    explicit ShardsEstimator(size_t max_cap, size_t buckets = 100, size_t budget = 8192)
+        : bucket_size(std::max<size_t>(max_cap / std::max<size_t>(buckets, 1), 1)),
+          sample_budget(std::max<size_t>(budget, 1)),
+          threshold(UINT64_MAX),
+          fenwick(4 * std::max<size_t>(budget, 1) + 1, 0),
+          slot_owner(4 * std::max<size_t>(budget, 1), 0),
+          next_slot(0),
+          histogram((max_cap + bucket_size - 1) / bucket_size + 1, 0.0),
+          cold_misses(0),
+          sampled_refs(0),
+          total_refs(0) {}
+
+    bool sampled(uint64_t hash) const {
+        return hash < threshold;
+    }
+
+    uint64_t currentThreshold() const {
+        return threshold;
+    }
+
+    // 记录一次访问，hash由KeyCodec::hashKey()得到，可以在加锁前用sampled()过滤掉未采样的键
+    void access(uint64_t hash) {
+        total_refs++;
+        if (!sampled(hash)) {
+            return;
+        }
+        sampled_refs++;
+        if (next_slot == slot_owner.size()) {
+            compact();
+        }
+        double rate = static_cast<double>(threshold) / 18446744073709551616.0;
+
+        auto it = last_slot.find(hash);
+        if (it == last_slot.end()) {
+            cold_misses++;
+            tracked.insert(hash);
+        } else {
+            // 最后访问在它之后的键数就是采样空间中的重用距离
+            int distance = static_cast<int>(last_slot.size()) - fenwickPrefix(it->second);
+            double scaled = distance / rate;
+            size_t bucket = static_cast<size_t>(scaled) / bucket_size;
+            histogram[std::min(bucket, histogram.size() - 1)]++;
+            fenwickAdd(it->second, -1);
+        }
+
+        last_slot[hash] = next_slot;
+        slot_owner[next_slot] = hash;
+        fenwickAdd(next_slot, 1);
+        next_slot++;
+
+        if (tracked.size() > sample_budget) {
+            shrink();
+        }
+    }
+
+    // 预测容量为capacity(条目数)的LRU命中率，精度为一个桶
+    double hitRate(size_t capacity) const {
+        if (sampled_refs == 0) {
+            return 0.0;
+        }
+        size_t buckets = std::min(capacity / bucket_size, histogram.size() - 1);
+        double hits = 0;
+        for (size_t b = 0; b < buckets; b++) {
+            hits += histogram[b];
+        }
+        return hits / sampled_refs;
+    }
+
+    // (容量, 预测命中率)，每个桶一个点
+    std::vector<std::pair<size_t, double>> curve() const {
+        std::vector<std::pair<size_t, double>> points;
+        double hits = 0;
+        for (size_t b = 0; b + 1 < histogram.size(); b++) {
+            hits += histogram[b];
+            points.emplace_back((b + 1) * bucket_size, sampled_refs ? hits / sampled_refs : 0.0);
+        }
+        return points;
+    }
+
+    double samplingRate() const {
+        return static_cast<double>(threshold) / 18446744073709551616.0;
+    }
+
+    size_t trackedKeys() const {
+        return last_slot.size();
+    }
+
+    uint64_t totalRefs() const {
+        return total_refs;
+    }
+};
+
+// 挂在运行中的缓存上的缺失率曲线监视器，接口与底层缓存相同，每次get都记录到估计器
+// 未被采样的键只计算一次哈希，不加锁；被采样的键在监视器自己的锁内更新估计器，
+// 因此底层缓存是线程安全的(ShardedCache等)时，监视器也可以被多个线程同时使用。
+template<typename CacheType>
+class MissRatioMonitor {
+private:
+    CacheType cache;
+    ShardsEstimator estimator;
+    std::mutex estimator_mutex;
+    std::atomic<uint64_t> threshold;
+
+    void record(std::string_view key) {
+        uint64_t hash = KeyCodec::hashKey(key);
+        if (hash >= threshold.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(estimator_mutex);
+        estimator.access(hash);
+        threshold.store(estimator.currentThreshold(), std::memory_order_relaxed);
+    }
+
+public:
+    // max_cap和budget传给估计器，其余参数原样传给底层缓存的构造函数
+    template<typename... Args>
+    MissRatioMonitor(size_t max_cap, size_t budget, const Args&... args)
+        : cache(args...), estimator(max_cap, 100, budget), threshold(UINT64_MAX) {}
+
+    template<typename V>
+    bool get(std::string_view key, V& value) {
+        record(key);
+        return cache.get(key, value);
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        cache.put(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    bool erase(std::string_view key) {
+        return cache.erase(key);
+    }
+
+    size_t size() {
+        return cache.size();
+    }
+
+    CacheType& underlying() {
+        return cache;
+    }
+
+    std::vector<std::pair<size_t, double>> curve() {
+        std::lock_guard<std::mutex> lock(estimator_mutex);
+        return estimator.curve();
+    }
+
+    double predictedHitRate(size_t capacity) {
+        std::lock_guard<std::mutex> lock(estimator_mutex);
+        return estimator.hitRate(capacity);
+    }
+};
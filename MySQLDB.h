@@ -0,0 +1,374 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <mysql/mysql.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BackingStore.h"
+
+// 使用预处理语句的MySQL连接
+// 连接建立后预处理get和upsert两条语句，每次调用只发送参数，服务器不再重新解析SQL。
+// 结果通过二进制协议直接写入预先分配的缓冲区，不经过mysql_store_result和vector<vector<string>>。
+// 值超过缓冲区时扩大缓冲区并用mysql_stmt_fetch_column重新读取该列。
+// 一个连接同一时间只能被一个线程使用，多线程通过MySQLConnectionPool共享连接。
+class MySQLConnection {
+private:
+    MYSQL* connection;
+    MYSQL_STMT* get_stmt;
+    MYSQL_STMT* put_stmt;
+
+    // get语句的结果缓冲区
+    std::vector<char> value_buffer;
+    unsigned long value_length;
+    bool value_is_null;
+    bool value_error;
+    MYSQL_BIND result_bind;
+
+    MYSQL_STMT* prepare(const char* sql) {
+        MYSQL_STMT* stmt = mysql_stmt_init(connection);
+        if (!stmt) {
+            std::cerr << "Statement initialization failed: " << mysql_error(connection) << std::endl;
+            return nullptr;
+        }
+        if (mysql_stmt_prepare(stmt, sql, std::strlen(sql))) {
+            std::cerr << "Statement preparation failed: " << mysql_stmt_error(stmt) << std::endl;
+            mysql_stmt_close(stmt);
+            return nullptr;
+        }
+        return stmt;
+    }
+
+    static void bindString(MYSQL_BIND& bind, const std::string& text, unsigned long& length) {
+        std::memset(&bind, 0, sizeof(bind));
+        length = text.size();
+        bind.buffer_type = MYSQL_TYPE_STRING;
+        bind.buffer = const_cast<char*>(text.data());
+        bind.buffer_length = text.size();
+        bind.length = &length;
+    }
+
+    void bindResult() {
+        std::memset(&result_bind, 0, sizeof(result_bind));
+        result_bind.buffer_type = MYSQL_TYPE_STRING;
+        result_bind.buffer = value_buffer.data();
+        result_bind.buffer_length = value_buffer.size();
+        result_bind.length = &value_length;
+        result_bind.is_null = &value_is_null;
+        result_bind.error = &value_error;
+        mysql_stmt_bind_result(get_stmt, &result_bind);
+    }
+
+    void close() {
+        if (get_stmt) {
+            mysql_stmt_close(get_stmt);
+            get_stmt = nullptr;
+        }
+        if (put_stmt) {
+            mysql_stmt_close(put_stmt);
+            put_stmt = nullptr;
+        }
+        if (connection) {
+            mysql_close(connection);
+            connection = nullptr;
+        }
+    }
+
+public:
+    MySQLConnection()
+        : connection(nullptr), get_stmt(nullptr), put_stmt(nullptr), value_buffer(4096),
+          value_length(0), value_is_null(false), value_error(false) {}
+
+    MySQLConnection(const MySQLConnection&) = delete;
+    MySQLConnection& operator=(const MySQLConnection&) = delete;
+
+    ~MySQLConnection() {
+        close();
+    }
+
+    // 底层连接，供执行任意SQL和批量查询使用
+    MYSQL* handle() const {
+        return connection;
+    }
+
+    bool connect(const std::string& host, const std::string& user,
+                 const std::string& password, const std::string& database, int port = 3306) {
+        connection = mysql_init(nullptr);
+        if (!connection) {
+            std::cerr << "MySQL initialization failed" << std::endl;
+            return false;
+        }
+        if (!mysql_real_connect(connection, host.c_str(), user.c_str(),
+                               password.c_str(), database.c_str(), port, nullptr, 0)) {
+            std::cerr << "MySQL connection failed: " << mysql_error(connection) << std::endl;
+            close();
+            return false;
+        }
+
+        get_stmt = prepare("SELECT cache_value FROM cache_test WHERE cache_key = ?");
+        put_stmt = prepare("INSERT INTO cache_test (cache_key, cache_value) VALUES (?, ?) "
+                           "ON DUPLICATE KEY UPDATE cache_value = VALUES(cache_value)");
+        if (!get_stmt || !put_stmt) {
+            close();
+            return false;
+        }
+        bindResult();
+        return true;
+    }
+
+    bool getData(const std::string& key, std::string& value) {
+        MYSQL_BIND param;
+        unsigned long key_length;
+        bindString(param, key, key_length);
+        if (mysql_stmt_bind_param(get_stmt, &param) || mysql_stmt_execute(get_stmt)) {
+            std::cerr << "Query execution failed: " << mysql_stmt_error(get_stmt) << std::endl;
+            return false;
+        }
+
+        int status = mysql_stmt_fetch(get_stmt);
+        bool found = false;
+        if (status == 0 || status == MYSQL_DATA_TRUNCATED) {
+            if (status == MYSQL_DATA_TRUNCATED) {
+                // 值比缓冲区大：扩大缓冲区，重新读取这一列，之后的查询直接使用新缓冲区
+                value_buffer.resize(value_length);
+                bindResult();
+                MYSQL_BIND column = result_bind;
+                mysql_stmt_fetch_column(get_stmt, &column, 0, 0);
+            }
+            if (!value_is_null) {
+                value.assign(value_buffer.data(), value_length);
+                found = true;
+            }
+            // cache_key是主键，最多一行；读完结果集才能再次执行语句
+            while (mysql_stmt_fetch(get_stmt) == 0) {
+            }
+        }
+        mysql_stmt_free_result(get_stmt);
+        return found;
+    }
+
+    bool putData(const std::string& key, const std::string& value) {
+        MYSQL_BIND params[2];
+        unsigned long lengths[2];
+        bindString(params[0], key, lengths[0]);
+        bindString(params[1], value, lengths[1]);
+        if (mysql_stmt_bind_param(put_stmt, params) || mysql_stmt_execute(put_stmt)) {
+            std::cerr << "Query execution failed: " << mysql_stmt_error(put_stmt) << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+// MySQL数据库连接类，单个连接，不能被多个线程同时使用
+// 单行读写使用MySQLConnection的预处理语句，键和值作为参数发送，不拼接进SQL；批量读写拼接时逐个转义。
+class MySQLDB : public BackingStore {
+private:
+    MySQLConnection connection;
+    
+public:
+    MySQLDB() {}
+    
+    bool connect(const std::string& host, const std::string& user, 
+                 const std::string& password, const std::string& database, int port = 3306) {
+        if (!connection.connect(host, user, password, database, port)) {
+            return false;
+        }
+        
+        std::cout << "Connected to MySQL database successfully!" << std::endl;
+        return true;
+    }
+    
+    bool executeQuery(const std::string& query, std::vector<std::vector<std::string>>& results) {
+        if (mysql_query(connection.handle(), query.c_str())) {
+            std::cerr << "Query execution failed: " << mysql_error(connection.handle()) << std::endl;
+            return false;
+        }
+        
+        MYSQL_RES* result = mysql_store_result(connection.handle());
+        if (!result) {
+            return true; // 查询成功但无结果(如INSERT, UPDATE等)
+        }
+        
+        int num_fields = mysql_num_fields(result);
+        MYSQL_ROW row;
+        
+        while ((row = mysql_fetch_row(result))) {
+            std::vector<std::string> row_data;
+            for (int i = 0; i < num_fields; i++) {
+                row_data.push_back(row[i] ? row[i] : "NULL");
+            }
+            results.push_back(row_data);
+        }
+        
+        mysql_free_result(result);
+        return true;
+    }
+    
+    bool getData(const std::string& key, std::string& value) override {
+        return connection.getData(key, value);
+    }
+    
+    // 一次查询多个键，找到的(键, 值)追加到rows。直接遍历结果集，不经过vector<vector<string>>
+    bool getDataBatch(const std::vector<std::string>& keys,
+                      std::vector<std::pair<std::string, std::string>>& rows) override {
+        if (keys.empty()) {
+            return true;
+        }
+
+        std::string query = "SELECT cache_key, cache_value FROM cache_test WHERE cache_key IN (";
+        std::string escaped;
+        for (size_t i = 0; i < keys.size(); i++) {
+            escaped.resize(keys[i].size() * 2 + 1);
+            unsigned long length =
+                mysql_real_escape_string(connection.handle(), &escaped[0], keys[i].data(), keys[i].size());
+            query += i == 0 ? "'" : ",'";
+            query.append(escaped, 0, length);
+            query += '\'';
+        }
+        query += ')';
+
+        if (mysql_query(connection.handle(), query.c_str())) {
+            std::cerr << "Query execution failed: " << mysql_error(connection.handle()) << std::endl;
+            return false;
+        }
+        MYSQL_RES* result = mysql_store_result(connection.handle());
+        if (!result) {
+            return false;
+        }
+
+        MYSQL_ROW row;
+        while ((row = mysql_fetch_row(result))) {
+            unsigned long* lengths = mysql_fetch_lengths(result);
+            if (row[0] && row[1]) {
+                rows.emplace_back(std::string(row[0], lengths[0]), std::string(row[1], lengths[1]));
+            }
+        }
+
+        mysql_free_result(result);
+        return true;
+    }
+    
+    bool putData(const std::string& key, const std::string& value) override {
+        return connection.putData(key, value);
+    }
+    
+    // 多行upsert：一条INSERT ... VALUES (...), (...) ON DUPLICATE KEY UPDATE写入整批行
+    bool putDataBatch(const std::vector<std::pair<std::string, std::string>>& rows) override {
+        if (rows.empty()) {
+            return true;
+        }
+
+        std::string query = "INSERT INTO cache_test (cache_key, cache_value) VALUES ";
+        std::string escaped;
+        auto appendQuoted = [&](const std::string& text) {
+            escaped.resize(text.size() * 2 + 1);
+            unsigned long length =
+                mysql_real_escape_string(connection.handle(), &escaped[0], text.data(), text.size());
+            query += '\'';
+            query.append(escaped, 0, length);
+            query += '\'';
+        };
+        for (size_t i = 0; i < rows.size(); i++) {
+            query += i == 0 ? "(" : ",(";
+            appendQuoted(rows[i].first);
+            query += ',';
+            appendQuoted(rows[i].second);
+            query += ')';
+        }
+        query += " ON DUPLICATE KEY UPDATE cache_value = VALUES(cache_value)";
+
+        std::vector<std::vector<std::string>> results;
+        return executeQuery(query, results);
+    }
+};
+
+// 线程安全的MySQL连接池
+// 预先建立固定数量的连接，acquire()取出一个空闲连接，没有空闲连接时等待；Lease析构时归还。
+class MySQLConnectionPool {
+private:
+    std::vector<std::unique_ptr<MySQLConnection>> connections;
+    std::vector<MySQLConnection*> idle;
+    std::mutex mutex;
+    std::condition_variable available;
+
+    void release(MySQLConnection* connection) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(connection);
+        }
+        available.notify_one();
+    }
+
+public:
+    // 借出的连接，析构时归还到连接池
+    class Lease {
+    private:
+        MySQLConnectionPool* pool;
+        MySQLConnection* connection;
+
+    public:
+        Lease(MySQLConnectionPool* p, MySQLConnection* c) : pool(p), connection(c) {}
+
+        Lease(Lease&& other) noexcept : pool(other.pool), connection(other.connection) {
+            other.connection = nullptr;
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease() {
+            if (connection) {
+                pool->release(connection);
+            }
+        }
+
+        MySQLConnection* operator->() const {
+            return connection;
+        }
+    };
+
+    MySQLConnectionPool() {}
+
+    MySQLConnectionPool(const MySQLConnectionPool&) = delete;
+    MySQLConnectionPool& operator=(const MySQLConnectionPool&) = delete;
+
+    // 建立pool_size个连接，任何一个失败都返回false
+    bool connect(const std::string& host, const std::string& user, const std::string& password,
+                 const std::string& database, size_t pool_size, int port = 3306) {
+        for (size_t i = 0; i < pool_size; i++) {
+            std::unique_ptr<MySQLConnection> connection(new MySQLConnection());
+            if (!connection->connect(host, user, password, database, port)) {
+                return false;
+            }
+            idle.push_back(connection.get());
+            connections.push_back(std::move(connection));
+        }
+        return true;
+    }
+
+    Lease acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        available.wait(lock, [this]() { return !idle.empty(); });
+        MySQLConnection* connection = idle.back();
+        idle.pop_back();
+        return Lease(this, connection);
+    }
+
+    bool getData(const std::string& key, std::string& value) {
+        return acquire()->getData(key, value);
+    }
+
+    bool putData(const std::string& key, const std::string& value) {
+        return acquire()->putData(key, value);
+    }
+
+    size_t size() const {
+        return connections.size();
+    }
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// 基于节点池的侵入式LRU缓存
+// 所有节点在构造时一次性分配在连续的数组里，LRU双向链表和哈希桶链表的指针都直接存放在节点中。
+// 命中时只需调整链表指针，不做任何内存分配；缓存满后插入新键会就地复用被淘汰的节点。
+template<typename T>
+class PooledLRUCache {
+private:
+    struct Link {
+        Link* prev;
+        Link* next;
+
+        Link() : prev(this), next(this) {}
+    };
+
+    struct Node : Link {
+        std::string key;
+        T value;
+        size_t hash;
+        Node* hash_next;  // 同一哈希桶内的下一个节点，空闲时用作空闲链表
+
+        Node() : hash(0), hash_next(nullptr) {}
+    };
+
+    std::vector<Node> pool;
+    std::vector<Node*> buckets;
+    size_t bucket_mask;
+    Link lru;           // 哨兵节点：lru.next最久未使用，lru.prev最近使用
+    Node* free_list;
+    size_t count;
+    size_t capacity;
+    std::hash<std::string> hasher;
+
+    static void unlink(Link* node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+    }
+
+    void linkBack(Link* node) {
+        node->prev = lru.prev;
+        node->next = &lru;
+        lru.prev->next = node;
+        lru.prev = node;
+    }
+
+    Node* find(const std::string& key, size_t h) const {
+        for (Node* node = buckets[h & bucket_mask]; node; node = node->hash_next) {
+            if (node->hash == h && node->key == key) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
+
+    void removeFromBucket(Node* target) {
+        Node** slot = &buckets[target->hash & bucket_mask];
+        while (*slot != target) {
+            slot = &(*slot)->hash_next;
+        }
+        *slot = target->hash_next;
+    }
+
+    void addToBucket(Node* node) {
+        Node*& head = buckets[node->hash & bucket_mask];
+        node->hash_next = head;
+        head = node;
+    }
+
+public:
+    explicit PooledLRUCache(size_t cap) : pool(cap), free_list(nullptr), count(0), capacity(cap) {
+        // 桶数取不小于容量的2的幂，平均链长不超过1
+        size_t bucket_count = 1;
+        while (bucket_count < cap) {
+            bucket_count <<= 1;
+        }
+        buckets.assign(bucket_count, nullptr);
+        bucket_mask = bucket_count - 1;
+
+        for (size_t i = 0; i < cap; i++) {
+            pool[i].hash_next = free_list;
+            free_list = &pool[i];
+        }
+    }
+
+    // 节点之间互相引用，不允许拷贝
+    PooledLRUCache(const PooledLRUCache&) = delete;
+    PooledLRUCache& operator=(const PooledLRUCache&) = delete;
+
+    bool get(const std::string& key, T& value) {
+        Node* node = find(key, hasher(key));
+        if (node) {
+            value = node->value;
+            // 移到链表尾部(最近使用)
+            unlink(node);
+            linkBack(node);
+            return true;
+        }
+        return false;
+    }
+
+    void put(const std::string& key, const T& value) {
+        if (capacity == 0) {
+            return;
+        }
+
+        size_t h = hasher(key);
+        Node* node = find(key, h);
+        if (node) {
+            // 更新值并移到链表尾部
+            node->value = value;
+            unlink(node);
+            linkBack(node);
+            return;
+        }
+
+        if (free_list) {
+            node = free_list;
+            free_list = node->hash_next;
+            count++;
+        } else {
+            // 缓存已满，就地复用最久未使用的节点
+            node = static_cast<Node*>(lru.next);
+            unlink(node);
+            removeFromBucket(node);
+        }
+
+        // 赋值会复用节点中字符串已有的缓冲区
+        node->key = key;
+        node->value = value;
+        node->hash = h;
+        addToBucket(node);
+        linkBack(node);
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
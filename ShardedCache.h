@@ -0,0 +1,118 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "CacheStats.h"
+#include "FlatHashMap.h"
+
+// 分片线程安全缓存
+// 按键的哈希值把请求分散到N个分片，每个分片是一个独立加锁的底层缓存(FIFO/LRU/LFU/ARC)，
+// 不同分片上的操作互不阻塞。总容量平均分配到各分片，除不尽的部分分给前几个分片。
+template<typename CacheType>
+class ShardedCache {
+private:
+    struct Shard {
+        std::mutex mutex;
+        CacheType cache;
+
+        template<typename... Args>
+        explicit Shard(size_t cap, const Args&... args) : cache(cap, args...) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    FlatHash<std::string> hasher;
+
+    Shard& shardFor(std::string_view key) {
+        // 混合高位，避免与分片内哈希表的桶分布相关
+        size_t h = hasher(key) * 0x9E3779B97F4A7C15ULL;
+        return *shards[(h >> 32) % shards.size()];
+    }
+
+public:
+    // 额外参数(如Weigher)原样传给每个分片的构造函数
+    template<typename... Args>
+    ShardedCache(size_t cap, size_t shard_count, const Args&... args) {
+        if (shard_count == 0) {
+            shard_count = 1;
+        }
+        // 余数分给前cap % shard_count个分片，各分片容量之和正好是cap
+        size_t shard_cap = cap / shard_count;
+        size_t remainder = cap % shard_count;
+        shards.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; i++) {
+            shards.push_back(std::unique_ptr<Shard>(new Shard(shard_cap + (i < remainder), args...)));
+        }
+    }
+
+    template<typename T>
+    bool get(std::string_view key, T& value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.get(key, value);
+    }
+
+    // 返回值句柄，释放分片锁后句柄仍然有效
+    auto get(std::string_view key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.get(key);
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.cache.put(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    template<typename K, typename... Args>
+    bool emplace(K&& key, Args&&... args) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.emplace(std::forward<K>(key), std::forward<Args>(args)...);
+    }
+
+    bool erase(std::string_view key) {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.cache.erase(key);
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->cache.size();
+        }
+        return total;
+    }
+
+    // 各分片总权重之和，要求底层缓存提供weight()
+    size_t weight() {
+        size_t total = 0;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total += shard->cache.weight();
+        }
+        return total;
+    }
+
+    // 各分片统计之和，要求底层缓存提供stats()
+    CacheStatsSnapshot stats() {
+        CacheStatsSnapshot total;
+        for (auto& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            total.merge(shard->cache.stats());
+        }
+        return total;
+    }
+
+    size_t shardCount() const {
+        return shards.size();
+    }
+};
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// 按大小分级的slab分配器
+// 申请的大小向上取整到某个大小级别，每个级别从64KB的slab中顺序切出等长的块，释放的块挂在该级别的空闲链表上。
+// 级别：128字节以内按16字节递增，之后每级约增大1/8，直到kMaxChunkSize；更大的申请直接使用operator new，
+// 前面附加16字节的链表头，串在分配器的大块链表上。
+// slab中的块没有单独的头部，也不单独向malloc申请，释放时由调用者给出申请时的大小。
+// 析构时释放所有slab和尚未释放的大块，使用者不需要逐个释放。不是线程安全的。
+class SlabAllocator {
+private:
+    static const size_t kSlabSize = 64 * 1024;
+    static const size_t kMaxChunkSize = 8192;
+
+    struct FreeChunk {
+        FreeChunk* next;
+    };
+
+    // 大块的头部，16字节，保持返回地址16字节对齐
+    struct LargeBlock {
+        LargeBlock* prev;
+        LargeBlock* next;
+    };
+
+    static_assert(sizeof(LargeBlock) == 16, "large block header must keep 16-byte alignment");
+
+    struct SizeClass {
+        size_t chunk_size;
+        FreeChunk* free_list;
+        char* cursor;  // 当前slab中尚未切出的部分
+        char* end;
+    };
+
+    std::vector<SizeClass> classes;
+    std::vector<char*> slabs;
+    LargeBlock large_blocks;  // 哨兵
+    size_t used_bytes;
+    size_t large_bytes;
+
+    size_t classIndex(size_t size) const {
+        if (size <= 128) {
+            return size == 0 ? 0 : (size - 1) / 16;
+        }
+        return std::lower_bound(classes.begin(), classes.end(), size,
+                                [](const SizeClass& c, size_t n) { return c.chunk_size < n; }) - classes.begin();
+    }
+
+public:
+    SlabAllocator() : used_bytes(0), large_bytes(0) {
+        large_blocks.prev = large_blocks.next = &large_blocks;
+        for (size_t size = 16; size <= kMaxChunkSize;) {
+            classes.push_back(SizeClass{size, nullptr, nullptr, nullptr});
+            size = size < 128 ? size + 16 : (size + size / 8 + 15) & ~size_t(15);
+        }
+        if (classes.back().chunk_size != kMaxChunkSize) {
+            classes.push_back(SizeClass{kMaxChunkSize, nullptr, nullptr, nullptr});
+        }
+    }
+
+    ~SlabAllocator() {
+        for (char* slab : slabs) {
+            ::operator delete(slab);
+        }
+        while (large_blocks.next != &large_blocks) {
+            LargeBlock* block = large_blocks.next;
+            large_blocks.next = block->next;
+            ::operator delete(block);
+        }
+    }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    // 返回的内存按16字节对齐
+    void* allocate(size_t size) {
+        if (size > kMaxChunkSize) {
+            LargeBlock* block = static_cast<LargeBlock*>(::operator new(sizeof(LargeBlock) + size));
+            block->prev = &large_blocks;
+            block->next = large_blocks.next;
+            large_blocks.next->prev = block;
+            large_blocks.next = block;
+            large_bytes += size;
+            return block + 1;
+        }
+        SizeClass& c = classes[classIndex(size)];
+        used_bytes += c.chunk_size;
+        if (c.free_list) {
+            FreeChunk* chunk = c.free_list;
+            c.free_list = chunk->next;
+            return chunk;
+        }
+        if (!c.cursor || c.cursor + c.chunk_size > c.end) {
+            char* slab = static_cast<char*>(::operator new(kSlabSize));
+            slabs.push_back(slab);
+            c.cursor = slab;
+            c.end = slab + kSlabSize - kSlabSize % c.chunk_size;
+        }
+        void* chunk = c.cursor;
+        c.cursor += c.chunk_size;
+        return chunk;
+    }
+
+    // size必须与allocate时相同
+    void deallocate(void* p, size_t size) {
+        if (size > kMaxChunkSize) {
+            LargeBlock* block = static_cast<LargeBlock*>(p) - 1;
+            block->prev->next = block->next;
+            block->next->prev = block->prev;
+            large_bytes -= size;
+            ::operator delete(block);
+            return;
+        }
+        SizeClass& c = classes[classIndex(size)];
+        used_bytes -= c.chunk_size;
+        FreeChunk* chunk = static_cast<FreeChunk*>(p);
+        chunk->next = c.free_list;
+        c.free_list = chunk;
+    }
+
+    // size实际占用的块大小，两个大小的块大小相同时可以原地复用
+    size_t chunkSize(size_t size) const {
+        return size > kMaxChunkSize ? size : classes[classIndex(size)].chunk_size;
+    }
+
+    // 已切出且未释放的块的总大小
+    size_t usedBytes() const {
+        return used_bytes + large_bytes;
+    }
+
+    // 向系统申请的总字节数(slab和大块)
+    size_t reservedBytes() const {
+        return slabs.size() * kSlabSize + large_bytes;
+    }
+};
+
+// 标准分配器接口的适配，可以作为Cache的Alloc参数或用于标准容器。
+// 默认构造时创建自己的SlabAllocator，rebind得到的分配器共享同一个
+template<typename T>
+class SlabStdAllocator {
+private:
+    template<typename U>
+    friend class SlabStdAllocator;
+
+    std::shared_ptr<SlabAllocator> slab;
+
+public:
+    typedef T value_type;
+
+    SlabStdAllocator() : slab(std::make_shared<SlabAllocator>()) {}
+
+    template<typename U>
+    SlabStdAllocator(const SlabStdAllocator<U>& other) : slab(other.slab) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(slab->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        slab->deallocate(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const SlabStdAllocator<U>& other) const {
+        return slab == other.slab;
+    }
+
+    template<typename U>
+    bool operator!=(const SlabStdAllocator<U>& other) const {
+        return slab != other.slab;
+    }
+};
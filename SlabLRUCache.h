@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "SlabAllocator.h"
+
+// 值在记录中的存储方式：std::string存原始字节，其他类型必须是可平凡复制的，按内存布局直接拷贝
+template<typename T>
+struct InlineValue {
+    static_assert(std::is_trivially_copyable<T>::value, "inline values must be std::string or trivially copyable");
+
+    static size_t size(const T&) {
+        return sizeof(T);
+    }
+
+    static void store(char* dest, const T& value) {
+        std::memcpy(dest, &value, sizeof(T));
+    }
+
+    static void load(const char* src, size_t, T& value) {
+        std::memcpy(&value, src, sizeof(T));
+    }
+};
+
+template<>
+struct InlineValue<std::string> {
+    static size_t size(const std::string& value) {
+        return value.size();
+    }
+
+    static void store(char* dest, const std::string& value) {
+        std::memcpy(dest, value.data(), value.size());
+    }
+
+    static void load(const char* src, size_t len, std::string& value) {
+        value.assign(src, len);
+    }
+};
+
+// 基于slab分配器的紧凑LRU缓存
+// 每个条目是一条连续的记录：40字节的头部(LRU链表指针、哈希桶链表指针、哈希值、键和值的长度)后面紧跟键和值的字节，
+// 整条记录从SlabAllocator的一个大小级别中分配，不再有链表节点、shared_ptr控制块和字符串缓冲区等单独的堆块。
+// 索引是记录内链接的哈希桶，键只保存一份。get拷贝出值，不提供值句柄。capacity是条目数上限。
+template<typename T>
+class SlabLRUCache {
+private:
+    struct Record {
+        Record* prev;
+        Record* next;
+        Record* hash_next;  // 同一哈希桶内的下一条记录
+        size_t hash;
+        uint32_t key_len;
+        uint32_t value_len;
+
+        char* data() {
+            return reinterpret_cast<char*>(this + 1);
+        }
+
+        std::string_view key() const {
+            return std::string_view(reinterpret_cast<const char*>(this + 1), key_len);
+        }
+
+        const char* value() const {
+            return reinterpret_cast<const char*>(this + 1) + key_len;
+        }
+
+        size_t bytes() const {
+            return sizeof(Record) + key_len + value_len;
+        }
+    };
+
+    static_assert(sizeof(Record) == 40, "unexpected slab record header size");
+
+    SlabAllocator slab;
+    std::vector<Record*> buckets;
+    size_t bucket_mask;
+    Record lru;  // 哨兵：lru.next最久未使用，lru.prev最近使用
+    size_t count;
+    size_t capacity;
+    std::hash<std::string_view> hasher;
+
+    static void unlink(Record* record) {
+        record->prev->next = record->next;
+        record->next->prev = record->prev;
+    }
+
+    void linkBack(Record* record) {
+        record->prev = lru.prev;
+        record->next = &lru;
+        lru.prev->next = record;
+        lru.prev = record;
+    }
+
+    Record* find(std::string_view key, size_t h) const {
+        for (Record* record = buckets[h & bucket_mask]; record; record = record->hash_next) {
+            if (record->hash == h && record->key() == key) {
+                return record;
+            }
+        }
+        return nullptr;
+    }
+
+    void removeFromBucket(Record* target) {
+        Record** slot = &buckets[target->hash & bucket_mask];
+        while (*slot != target) {
+            slot = &(*slot)->hash_next;
+        }
+        *slot = target->hash_next;
+    }
+
+    void addToBucket(Record* record) {
+        Record*& head = buckets[record->hash & bucket_mask];
+        record->hash_next = head;
+        head = record;
+    }
+
+    void remove(Record* record) {
+        unlink(record);
+        removeFromBucket(record);
+        slab.deallocate(record, record->bytes());
+        count--;
+    }
+
+    // 写入键和值，record已经分配好足够的空间
+    static void fill(Record* record, std::string_view key, const T& value, size_t h) {
+        record->hash = h;
+        record->key_len = static_cast<uint32_t>(key.size());
+        record->value_len = static_cast<uint32_t>(InlineValue<T>::size(value));
+        std::memcpy(record->data(), key.data(), key.size());
+        InlineValue<T>::store(record->data() + key.size(), value);
+    }
+
+public:
+    explicit SlabLRUCache(size_t cap) : count(0), capacity(cap) {
+        // 桶数取不小于容量的2的幂，平均链长不超过1
+        size_t bucket_count = 1;
+        while (bucket_count < cap) {
+            bucket_count <<= 1;
+        }
+        buckets.assign(bucket_count, nullptr);
+        bucket_mask = bucket_count - 1;
+        lru.prev = lru.next = &lru;
+    }
+
+    // 记录之间互相引用，不允许拷贝；记录都是原始字节，不需要逐条析构，内存(包括超过8KB的大记录)由slab析构时统一释放
+    SlabLRUCache(const SlabLRUCache&) = delete;
+    SlabLRUCache& operator=(const SlabLRUCache&) = delete;
+
+    bool get(std::string_view key, T& value) {
+        Record* record = find(key, hasher(key));
+        if (!record) {
+            return false;
+        }
+        InlineValue<T>::load(record->value(), record->value_len, value);
+        unlink(record);
+        linkBack(record);
+        return true;
+    }
+
+    void put(std::string_view key, const T& value) {
+        if (capacity == 0) {
+            return;
+        }
+
+        size_t h = hasher(key);
+        size_t bytes = sizeof(Record) + key.size() + InlineValue<T>::size(value);
+        Record* record = find(key, h);
+        if (record) {
+            if (slab.chunkSize(record->bytes()) == slab.chunkSize(bytes)) {
+                // 新记录落在同一个大小级别，原地改写
+                fill(record, key, value, h);
+                unlink(record);
+                linkBack(record);
+                return;
+            }
+            remove(record);
+        } else if (count >= capacity) {
+            remove(lru.next);
+        }
+
+        record = static_cast<Record*>(slab.allocate(bytes));
+        fill(record, key, value, h);
+        addToBucket(record);
+        linkBack(record);
+        count++;
+    }
+
+    // 删除键，返回是否存在
+    bool erase(std::string_view key) {
+        Record* record = find(key, hasher(key));
+        if (!record) {
+            return false;
+        }
+        remove(record);
+        return true;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    // 记录实际占用的字节数(按大小级别取整)和slab向系统申请的字节数
+    size_t usedBytes() const {
+        return slab.usedBytes();
+    }
+
+    size_t reservedBytes() const {
+        return slab.reservedBytes();
+    }
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <time.h>
+
+// 粗粒度单调时钟，单位ms。Linux上使用CLOCK_MONOTONIC_COARSE：vDSO直接返回内核在上一次时钟中断时记录的时间，
+// 不读硬件计数器，每次只需几纳秒，精度为一个时钟中断周期(通常1~4ms)。其他平台退回steady_clock
+inline uint64_t coarseClockMs() {
+#ifdef CLOCK_MONOTONIC_COARSE
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+#else
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// 分层时间轮
+// 4层，每层64个槽位，时间单位为tick。第0层每个槽位对应1个tick，第L层每个槽位对应64^L个tick，
+// 共覆盖64^4个tick，更远的定时器先放在最高层，下降时再按真实到期时间重新放置。
+// 定时器是侵入式双向链表节点，由使用者持有；加入、取消、重新调度都是O(1)，
+// 推进时间时每个定时器最多下降3次，均摊O(1)。每层用64位掩码记录非空槽位，推进时直接跳到下一个
+// 有定时器到期或需要下降的tick，中间的空tick不逐个处理，定时器稀疏时推进很长时间也只需几步。
+class TimingWheel {
+public:
+    struct Timer {
+        uint64_t deadline = 0;
+        Timer* prev = nullptr;
+        Timer* next = nullptr;
+
+        bool scheduled() const {
+            return prev != nullptr;
+        }
+    };
+
+private:
+    static const int kLevels = 4;
+    static const int kSlotBits = 6;
+    static const uint64_t kSlots = 1 << kSlotBits;
+    static const uint64_t kSlotMask = kSlots - 1;
+
+    // 每个槽位是一个带哨兵的循环链表，第level层第index个槽位在slots[level * kSlots + index]
+    Timer slots[kLevels * kSlots];
+    uint64_t occupied[kLevels];  // 每层非空槽位的掩码
+    uint64_t current_tick;
+    size_t timer_count;
+
+    void link(int level, uint64_t index, Timer* timer) {
+        Timer& head = slots[level * kSlots + index];
+        timer->prev = head.prev;
+        timer->next = &head;
+        head.prev->next = timer;
+        head.prev = timer;
+        occupied[level] |= uint64_t(1) << index;
+    }
+
+    void unlink(Timer* timer) {
+        Timer* prev = timer->prev;
+        prev->next = timer->next;
+        timer->next->prev = prev;
+        timer->prev = nullptr;
+        timer->next = nullptr;
+        // 链表只剩哨兵时prev就是槽位的哨兵
+        if (prev == prev->next) {
+            size_t position = prev - slots;
+            occupied[position / kSlots] &= ~(uint64_t(1) << (position % kSlots));
+        }
+    }
+
+    // 按到期时间与当前时间的距离选择层，按到期时间本身的对应位选择槽位。要求deadline >= current_tick
+    void place(Timer* timer) {
+        uint64_t deadline = timer->deadline;
+        uint64_t delta = deadline - current_tick;
+        for (int level = 0; level < kLevels; level++) {
+            if (delta < (kSlots << (level * kSlotBits))) {
+                link(level, (deadline >> (level * kSlotBits)) & kSlotMask, timer);
+                return;
+            }
+        }
+        // 超出时间轮范围，放到最高层最远的槽位，下降时重新计算
+        uint64_t farthest = current_tick + (kSlots << ((kLevels - 1) * kSlotBits)) - 1;
+        link(kLevels - 1, (farthest >> ((kLevels - 1) * kSlotBits)) & kSlotMask, timer);
+    }
+
+    // 把上层一个槽位中的定时器按剩余时间重新放到下层
+    void cascade(int level, uint64_t index) {
+        Timer& head = slots[level * kSlots + index];
+        while (head.next != &head) {
+            Timer* timer = head.next;
+            unlink(timer);
+            place(timer);
+        }
+    }
+
+    // current_tick之后第一个需要处理的tick：第0层非空槽位到期，或上层非空槽位下降。
+    // 第level层第index个槽位在第level层的时间单位(64^level个tick)编号与index同余、且低位全为0的tick处理
+    uint64_t nextEventTick() const {
+        uint64_t next = UINT64_MAX;
+        for (int level = 0; level < kLevels; level++) {
+            if (!occupied[level]) {
+                continue;
+            }
+            int shift = level * kSlotBits;
+            uint64_t first = (current_tick >> shift) + 1;  // 之后第一个以本层单位对齐的编号
+            int rotate = static_cast<int>(first & kSlotMask);
+            uint64_t mask = occupied[level];
+            uint64_t rotated = rotate ? (mask >> rotate) | (mask << (kSlots - rotate)) : mask;
+            uint64_t tick = (first + __builtin_ctzll(rotated)) << shift;
+            if (tick < next) {
+                next = tick;
+            }
+        }
+        return next;
+    }
+
+public:
+    explicit TimingWheel(uint64_t start_tick = 0) : current_tick(start_tick), timer_count(0) {
+        for (Timer& head : slots) {
+            head.prev = head.next = &head;
+        }
+        for (uint64_t& mask : occupied) {
+            mask = 0;
+        }
+    }
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    // 加入或重新调度定时器
+    void schedule(Timer* timer, uint64_t deadline) {
+        if (timer->scheduled()) {
+            unlink(timer);
+        } else {
+            timer_count++;
+        }
+        // 当前tick的槽位已经处理过，已到期的放到下一个tick
+        timer->deadline = deadline > current_tick ? deadline : current_tick + 1;
+        place(timer);
+    }
+
+    void cancel(Timer* timer) {
+        if (timer->scheduled()) {
+            unlink(timer);
+            timer_count--;
+        }
+    }
+
+    // 推进到now，对每个到期的定时器调用on_expire。回调时定时器已从时间轮移除，回调中可以释放它
+    template<typename Callback>
+    void advance(uint64_t now, Callback on_expire) {
+        while (current_tick < now) {
+            // 跳过没有定时器到期、也没有槽位下降的tick
+            uint64_t next = timer_count ? nextEventTick() : UINT64_MAX;
+            if (next > now) {
+                current_tick = now;
+                return;
+            }
+            current_tick = next;
+            // 低位归零时，上一层对应的槽位下降到本层
+            for (int level = 1; level < kLevels; level++) {
+                if ((current_tick >> ((level - 1) * kSlotBits)) & kSlotMask) {
+                    break;
+                }
+                cascade(level, (current_tick >> (level * kSlotBits)) & kSlotMask);
+            }
+
+            Timer& head = slots[current_tick & kSlotMask];
+            while (head.next != &head) {
+                Timer* timer = head.next;
+                unlink(timer);
+                timer_count--;
+                on_expire(timer);
+            }
+        }
+    }
+
+    uint64_t now() const {
+        return current_tick;
+    }
+
+    size_t size() const {
+        return timer_count;
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <list>
+#include <string>
+#include "CachePolicy.h"
+#include "FlatHashMap.h"
+#include "FrequencySketch.h"
+
+// W-TinyLFU缓存实现
+// 新条目先进入容量为1%的LRU窗口，从窗口淘汰出来的候选者要和主区域(分段LRU)的淘汰者比较，
+// 只有估计频率更高时才能进入主区域，否则直接丢弃。主区域分为试用段(20%)和保护段(80%)，
+// 试用段中再次命中的条目升入保护段。
+template<typename T>
+class TinyLFUCache {
+private:
+    enum Segment { WINDOW = 0, PROBATION = 1, PROTECTED = 2 };
+
+    struct TinyLFUNode {
+        std::string key;
+        T value;
+        Segment segment;
+
+        TinyLFUNode(const std::string& k, const T& v) : key(k), value(v), segment(WINDOW) {}
+    };
+
+    typedef std::list<TinyLFUNode> SegmentList;
+
+    // 三个分段，表头为最久未使用
+    SegmentList segments[3];
+    FlatHashMap<std::string, typename SegmentList::iterator> index;
+    FrequencySketch sketch;
+
+    size_t capacity;
+    size_t window_capacity;
+    size_t protected_capacity;
+    size_t main_capacity;
+    size_t last_miss_hash;  // 最近一次未命中的键，紧随其后的put不再重复计数
+
+    void moveTo(typename SegmentList::iterator node, Segment to) {
+        SegmentList& dest = segments[to];
+        dest.splice(dest.end(), segments[node->segment], node);
+        node->segment = to;
+    }
+
+    void evict(typename SegmentList::iterator node) {
+        index.erase(node->key);
+        segments[node->segment].erase(node);
+    }
+
+    // 试用段命中的条目升入保护段，保护段超出容量时把最久未使用的降回试用段
+    void promote(typename SegmentList::iterator node) {
+        moveTo(node, PROTECTED);
+        if (segments[PROTECTED].size() > protected_capacity) {
+            moveTo(segments[PROTECTED].begin(), PROBATION);
+        }
+    }
+
+    // 窗口超出容量时，窗口淘汰的候选者与主区域的淘汰者按频率竞争
+    void admitFromWindow() {
+        while (segments[WINDOW].size() > window_capacity) {
+            auto candidate = segments[WINDOW].begin();
+            size_t main_size = segments[PROBATION].size() + segments[PROTECTED].size();
+            if (main_size < main_capacity) {
+                moveTo(candidate, PROBATION);
+                continue;
+            }
+
+            if (main_size == 0) {
+                // 主区域容量为0(容量只有1)
+                evict(candidate);
+                continue;
+            }
+
+            Segment victim_segment = segments[PROBATION].empty() ? PROTECTED : PROBATION;
+            auto victim = segments[victim_segment].begin();
+            if (sketch.frequency(candidate->key) > sketch.frequency(victim->key)) {
+                evict(victim);
+                moveTo(candidate, PROBATION);
+            } else {
+                evict(candidate);
+            }
+        }
+    }
+
+public:
+    explicit TinyLFUCache(size_t cap) : sketch(cap), capacity(cap), last_miss_hash(0) {
+        window_capacity = cap / 100 > 0 ? cap / 100 : 1;
+        if (window_capacity >= cap) {
+            window_capacity = cap;
+        }
+        main_capacity = cap - window_capacity;
+        protected_capacity = main_capacity * 4 / 5;
+    }
+
+    bool get(const std::string& key, T& value) {
+        size_t hash = sketch.hashOf(key);
+        sketch.increment(hash);
+
+        auto it = index.find(key);
+        if (it == index.end()) {
+            last_miss_hash = hash;
+            return false;
+        }
+        auto node = it->second;
+        value = node->value;
+        if (node->segment == PROBATION) {
+            promote(node);
+        } else {
+            moveTo(node, node->segment);
+        }
+        return true;
+    }
+
+    void put(const std::string& key, const T& value) {
+        if (capacity == 0) {
+            return;
+        }
+
+        size_t hash = sketch.hashOf(key);
+        if (hash != last_miss_hash) {
+            sketch.increment(hash);
+        }
+        last_miss_hash = 0;
+
+        auto it = index.find(key);
+        if (it != index.end()) {
+            // 更新值
+            auto node = it->second;
+            node->value = value;
+            if (node->segment == PROBATION) {
+                promote(node);
+            } else {
+                moveTo(node, node->segment);
+            }
+            return;
+        }
+
+        // 新条目进入窗口
+        SegmentList& window = segments[WINDOW];
+        window.emplace_back(key, value);
+        index[key] = --window.end();
+        admitFromWindow();
+    }
+
+    size_t size() const {
+        return index.size();
+    }
+};
+
+// TinyLFU准入过滤器，作为现有缓存(如LRUCache)的前端
+// 新键写入会淘汰条目时，只有估计频率高于每一个将被淘汰的条目才会被写入，一次性访问和扫描无法挤走热点数据。
+// 是否淘汰、淘汰哪些条目按底层缓存的权重判断：按字节计算容量时，一个大条目可能挤出多个小条目，要逐个比较。
+// CacheType需要提供forEachVictim(key, value, visit)。
+template<typename CacheType>
+class TinyLFUAdmission {
+private:
+    CacheType cache;
+    FrequencySketch sketch;
+    size_t last_miss_hash;
+
+public:
+    explicit TinyLFUAdmission(size_t cap) : cache(cap), sketch(cap), last_miss_hash(0) {}
+
+    template<typename T>
+    bool get(const std::string& key, T& value) {
+        size_t hash = sketch.hashOf(key);
+        sketch.increment(hash);
+        if (cache.get(key, value)) {
+            return true;
+        }
+        last_miss_hash = hash;
+        return false;
+    }
+
+    template<typename T>
+    void put(const std::string& key, const T& value) {
+        size_t hash = sketch.hashOf(key);
+        if (hash != last_miss_hash) {
+            sketch.increment(hash);
+        }
+        last_miss_hash = 0;
+
+        int frequency = sketch.frequency(hash);
+        bool admit = true;
+        cache.forEachVictim(key, value, [&](const std::string& victim) {
+            admit = frequency > sketch.frequency(victim);
+            return admit;
+        });
+        if (admit) {
+            cache.put(key, value);
+        }
+    }
+
+    size_t size() const {
+        return cache.size();
+    }
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <endian.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "KeyCodec.h"
+
+// 二进制访问trace格式
+// 16字节文件头(魔数"CTRC"、版本号、记录数)，之后是连续的12字节记录：键的64位id + 对象字节数。
+// 所有整数按小端存储，写入时用htole转换，读取时经le*toh转换(小端机器上不产生指令)，
+// 记录仍可直接在映射上访问。键id由文本键经FNV-1a得到，与编译器和标准库无关，同一份trace可以在不同机器上回放。
+#pragma pack(push, 1)
+struct TraceRecord {
+    uint64_t key_le;
+    uint32_t size_le;
+
+    uint64_t key() const {
+        return le64toh(key_le);
+    }
+
+    uint32_t size() const {
+        return le32toh(size_le);
+    }
+};
+#pragma pack(pop)
+
+struct TraceHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t record_count;
+};
+
+static_assert(sizeof(TraceRecord) == 12, "trace record must be packed");
+static_assert(sizeof(TraceHeader) == 16, "unexpected trace header layout");
+
+namespace TraceFormat {
+    const char kMagic[4] = {'C', 'T', 'R', 'C'};
+    const uint32_t kVersion = 1;
+
+    inline uint64_t keyId(std::string_view key) {
+        return KeyCodec::checksum(key.data(), key.size());
+    }
+}
+
+// 只读映射一个trace文件，记录直接在映射上访问，不读入内存
+// 按顺序访问并提示内核预读，回放多GB的trace时常驻内存只有页缓存。
+class MappedTrace {
+private:
+    const void* mapping;
+    size_t mapping_size;
+    const TraceRecord* records;
+    size_t record_count;
+
+    void unmap() {
+        if (mapping) {
+            munmap(const_cast<void*>(mapping), mapping_size);
+            mapping = nullptr;
+        }
+        records = nullptr;
+        record_count = 0;
+    }
+
+public:
+    MappedTrace() : mapping(nullptr), mapping_size(0), records(nullptr), record_count(0) {}
+
+    ~MappedTrace() {
+        unmap();
+    }
+
+    MappedTrace(const MappedTrace&) = delete;
+    MappedTrace& operator=(const MappedTrace&) = delete;
+
+    bool open(const std::string& path) {
+        unmap();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Cannot open trace " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TraceHeader)) {
+            std::cerr << "Trace " << path << " is too small" << std::endl;
+            ::close(fd);
+            return false;
+        }
+        mapping_size = st.st_size;
+        void* addr = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            std::cerr << "Cannot map trace " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        mapping = addr;
+        madvise(addr, mapping_size, MADV_SEQUENTIAL);
+
+        const TraceHeader* header = static_cast<const TraceHeader*>(mapping);
+        if (std::memcmp(header->magic, TraceFormat::kMagic, sizeof(header->magic)) != 0 ||
+            le32toh(header->version) != TraceFormat::kVersion) {
+            std::cerr << "Trace " << path << " has an unknown format" << std::endl;
+            unmap();
+            return false;
+        }
+        // 记录数以文件实际长度为准，写入中断的文件也能回放已写完的部分
+        size_t available = (mapping_size - sizeof(TraceHeader)) / sizeof(TraceRecord);
+        uint64_t header_count = le64toh(header->record_count);
+        record_count = header_count < available ? header_count : available;
+        records = reinterpret_cast<const TraceRecord*>(static_cast<const char*>(mapping) + sizeof(TraceHeader));
+        return true;
+    }
+
+    size_t size() const {
+        return record_count;
+    }
+
+    const TraceRecord* begin() const {
+        return records;
+    }
+
+    const TraceRecord* end() const {
+        return records + record_count;
+    }
+};
+
+// 顺序写trace文件，关闭时回填记录数
+class TraceWriter {
+private:
+    FILE* file;
+    uint64_t record_count;
+
+public:
+    TraceWriter() : file(nullptr), record_count(0) {}
+
+    ~TraceWriter() {
+        close();
+    }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool open(const std::string& path) {
+        close();
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Cannot create trace " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        record_count = 0;
+        TraceHeader header;
+        std::memcpy(header.magic, TraceFormat::kMagic, sizeof(header.magic));
+        header.version = htole32(TraceFormat::kVersion);
+        header.record_count = 0;
+        return std::fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    bool append(uint64_t key, uint32_t size) {
+        TraceRecord record;
+        record.key_le = htole64(key);
+        record.size_le = htole32(size);
+        if (std::fwrite(&record, sizeof(record), 1, file) != 1) {
+            return false;
+        }
+        record_count++;
+        return true;
+    }
+
+    bool close() {
+        if (!file) {
+            return true;
+        }
+        uint64_t count_le = htole64(record_count);
+        bool ok = std::fseek(file, offsetof(TraceHeader, record_count), SEEK_SET) == 0 &&
+                  std::fwrite(&count_le, sizeof(count_le), 1, file) == 1;
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+    uint64_t size() const {
+        return record_count;
+    }
+};
+
+// 把每行一个键的文本日志转换为二进制trace，行可以是"键"或"键 字节数"，没有字节数时记为1
+// 逐行流式处理，不把日志读入内存。返回写入的记录数，失败返回-1
+inline long long importTextTrace(const std::string& text_path, const std::string& trace_path) {
+    std::ifstream in(text_path);
+    if (!in) {
+        std::cerr << "Cannot open " << text_path << std::endl;
+        return -1;
+    }
+    TraceWriter writer;
+    if (!writer.open(trace_path)) {
+        return -1;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        uint32_t size = 1;
+        size_t space = line.find_first_of(" \t");
+        std::string_view key(line);
+        if (space != std::string::npos) {
+            key = key.substr(0, space);
+            unsigned long parsed = std::strtoul(line.c_str() + space + 1, nullptr, 10);
+            if (parsed > 0) {
+                size = parsed > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(parsed);
+            }
+        }
+        if (!writer.append(TraceFormat::keyId(key), size)) {
+            std::cerr << "Write to " << trace_path << " failed" << std::endl;
+            return -1;
+        }
+    }
+    long long count = writer.size();
+    if (!writer.close()) {
+        std::cerr << "Write to " << trace_path << " failed" << std::endl;
+        return -1;
+    }
+    return count;
+}
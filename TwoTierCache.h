@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include "DiskTier.h"
+
+// 内存缓存加本地磁盘二级缓存
+// 内存缓存淘汰的条目(通过淘汰回调)追加到DiskTier；内存未命中时查磁盘，命中后提升回内存并从磁盘索引中删除，
+// 两级之间不重复保存同一个键。写入时删除磁盘上的旧值，避免内存再次淘汰前读到过期数据。
+// CacheType需要提供setEvictionListener(FIFO/LRU/LFU/ARC)。与底层缓存一样不是线程安全的。
+template<typename CacheType, typename T = std::string>
+class TwoTierCache {
+private:
+    CacheType cache;
+    DiskTier disk;
+    size_t memory_hits;
+    size_t disk_hits;
+    size_t miss_count;
+
+public:
+    // 磁盘层的参数在前，其余参数原样传给内存缓存的构造函数
+    template<typename... Args>
+    TwoTierCache(const std::string& directory, uint64_t segment_bytes, size_t segment_count, const Args&... args)
+        : cache(args...), disk(directory, segment_bytes, segment_count), memory_hits(0), disk_hits(0), miss_count(0) {
+        cache.setEvictionListener([this](const std::string& key, const T& value) {
+            disk.put(key, value);
+        });
+    }
+
+    TwoTierCache(const TwoTierCache&) = delete;
+    TwoTierCache& operator=(const TwoTierCache&) = delete;
+
+    bool get(std::string_view key, T& value) {
+        if (cache.get(key, value)) {
+            memory_hits++;
+            return true;
+        }
+        if (disk.get(key, value)) {
+            disk_hits++;
+            disk.erase(key);
+            cache.put(key, value);
+            return true;
+        }
+        miss_count++;
+        return false;
+    }
+
+    template<typename K, typename V>
+    void put(K&& key, V&& value) {
+        disk.erase(key);
+        cache.put(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    bool erase(std::string_view key) {
+        bool in_disk = disk.erase(key);
+        return cache.erase(key) || in_disk;
+    }
+
+    // 内存中的条目数
+    size_t size() const {
+        return cache.size();
+    }
+
+    size_t memoryHits() const {
+        return memory_hits;
+    }
+
+    size_t diskHits() const {
+        return disk_hits;
+    }
+
+    size_t misses() const {
+        return miss_count;
+    }
+
+    CacheType& memory() {
+        return cache;
+    }
+
+    DiskTier& diskTier() {
+        return disk;
+    }
+};
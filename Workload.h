@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// 预先生成的访问序列，在计时区间之外生成，计时循环只按下标取键，不调用随机数生成器
+// indices[i]是第i次访问的键下标，范围[0, key_count)。所有生成器都使用固定种子，结果可复现。
+struct Workload {
+    std::string name;
+    size_t key_count;
+    std::vector<int> indices;
+};
+
+// Zipf分布：下标k被抽中的概率正比于1/(k+1)^skew，预先计算累积分布后二分查找
+class ZipfDistribution {
+private:
+    std::vector<double> cdf;
+
+public:
+    ZipfDistribution(size_t n, double skew) : cdf(n) {
+        double sum = 0;
+        for (size_t k = 0; k < n; k++) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), skew);
+            cdf[k] = sum;
+        }
+        for (double& c : cdf) {
+            c /= sum;
+        }
+    }
+
+    template<typename Generator>
+    int operator()(Generator& gen) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+        size_t k = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        return static_cast<int>(std::min(k, cdf.size() - 1));
+    }
+};
+
+namespace Workloads {
+    // hot_share%的访问落在前hot_percent%的键上，其余均匀落在剩下的键上
+    inline Workload hotCold(size_t key_count, int ops, unsigned seed, int hot_percent = 20, int hot_share = 80) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> dis(0, key_count - 1);
+        std::discrete_distribution<> access_dist({static_cast<double>(hot_share), 100.0 - hot_share});
+        size_t hot_data_size = std::max<size_t>(key_count * hot_percent / 100, 1);
+
+        Workload w{std::to_string(hot_share) + "/" + std::to_string(hot_percent), key_count, {}};
+        w.indices.reserve(ops);
+        for (int i = 0; i < ops; i++) {
+            if (access_dist(gen) == 0 || hot_data_size == key_count) {
+                w.indices.push_back(dis(gen) % hot_data_size);
+            } else {
+                w.indices.push_back(hot_data_size + (dis(gen) % (key_count - hot_data_size)));
+            }
+        }
+        return w;
+    }
+
+    inline Workload uniform(size_t key_count, int ops, unsigned seed) {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<> dis(0, key_count - 1);
+        Workload w{"uniform", key_count, {}};
+        w.indices.reserve(ops);
+        for (int i = 0; i < ops; i++) {
+            w.indices.push_back(dis(gen));
+        }
+        return w;
+    }
+
+    // Zipf分布，最热的键是下标0
+    inline Workload zipf(size_t key_count, int ops, double skew, unsigned seed) {
+        std::mt19937 gen(seed);
+        ZipfDistribution dist(key_count, skew);
+        char name[32];
+        std::snprintf(name, sizeof(name), "zipf %.2f", skew);
+        Workload w{name, key_count, {}};
+        w.indices.reserve(ops);
+        for (int i = 0; i < ops; i++) {
+            w.indices.push_back(dist(gen));
+        }
+        return w;
+    }
+
+    // Zipf热集合中每隔scan_every次访问插入一段scan_length个只访问一次的键(顺序扫描)
+    // 扫描的键排在热集合之后，每次扫描接着上一次的位置，key_count包含全部扫描键
+    inline Workload scanMix(size_t hot_keys, int ops, double skew, size_t scan_length, int scan_every,
+                            unsigned seed) {
+        std::mt19937 gen(seed);
+        ZipfDistribution dist(hot_keys, skew);
+        Workload w{"zipf+scan", hot_keys, {}};
+        w.indices.reserve(ops);
+        size_t next_scan_key = hot_keys;
+        for (int i = 0; i < ops;) {
+            for (int j = 0; j < scan_every && i < ops; j++, i++) {
+                w.indices.push_back(dist(gen));
+            }
+            for (size_t j = 0; j < scan_length && i < ops; j++, i++) {
+                w.indices.push_back(static_cast<int>(next_scan_key++));
+            }
+        }
+        w.key_count = next_scan_key;
+        return w;
+    }
+
+    // 按顺序循环访问loop_length个键，大于缓存容量时LRU和FIFO一次也不会命中
+    inline Workload loop(size_t loop_length, int ops) {
+        Workload w{"loop " + std::to_string(loop_length), loop_length, {}};
+        w.indices.reserve(ops);
+        for (int i = 0; i < ops; i++) {
+            w.indices.push_back(static_cast<int>(i % loop_length));
+        }
+        return w;
+    }
+
+    // Zipf分布分成phases段，每段的热集合整体移动key_count / phases个键，考察策略对变化的适应速度
+    inline Workload phaseShift(size_t key_count, int ops, double skew, int phases, unsigned seed) {
+        std::mt19937 gen(seed);
+        ZipfDistribution dist(key_count, skew);
+        Workload w{"phase shift x" + std::to_string(phases), key_count, {}};
+        w.indices.reserve(ops);
+        int phase_length = std::max(ops / std::max(phases, 1), 1);
+        for (int i = 0; i < ops; i++) {
+            size_t offset = static_cast<size_t>(i / phase_length) * (key_count / std::max(phases, 1));
+            w.indices.push_back(static_cast<int>((dist(gen) + offset) % key_count));
+        }
+        return w;
+    }
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "FlatHashMap.h"
+
+// 延迟写(write-behind)缓冲区
+// 写入先进入合并缓冲区，同一个键只保留最后一次的值；后台线程在缓冲区达到max_batch行或
+// 最早的写入等待超过max_delay时，把缓冲区整体取出，按每批max_batch行调用flusher(如多行upsert)。
+// 缓冲区和正在写出的行合计不超过max_pending，满时write阻塞等待写出(背压)，内存有上限。
+// 析构或调用flush()时会把已接受的写入全部写出。flusher失败的行在没有更新的值时放回缓冲区，
+// 等待max_delay后重试；flush()在调用之后的一次写出失败或超时后返回false，不会无限期阻塞。
+// 析构时重新计算失败次数，连续失败kShutdownRetries次则放弃剩余的行并计入droppedRows()。
+template<typename T = std::string>
+class WriteBehindBuffer {
+public:
+    typedef std::vector<std::pair<std::string, T>> Batch;
+    // 写出一批行，返回是否成功
+    typedef std::function<bool(const Batch& rows)> Flusher;
+
+private:
+    Flusher flusher;
+    size_t max_batch;
+    size_t max_pending;
+    std::chrono::milliseconds max_delay;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;     // 通知后台线程
+    std::condition_variable space_ready;    // 通知被背压阻塞的写入者
+    std::condition_variable flush_done;     // 通知等待flush()的线程
+    Batch dirty;                             // 按首次写入顺序排列
+    FlatHashMap<std::string, size_t> dirty_index;  // 键 -> 在dirty中的位置
+    std::chrono::steady_clock::time_point oldest_write;
+    size_t in_flight;                        // 已取出、正在写出的行数
+    uint64_t accepted_generation;            // 已接受的写入批次号，flush()用来等待
+    uint64_t flushed_generation;
+    uint64_t write_attempts;                 // 已开始的写出次数
+    uint64_t failed_attempt;                 // 最近一次失败的写出的序号
+    bool stopping;
+    size_t waiting_flushers;                 // 正在flush()中等待的线程数
+    int consecutive_failures;
+    std::thread worker;
+
+    static const int kShutdownRetries = 3;
+
+    // 指标
+    std::atomic<size_t> flush_count;
+    std::atomic<size_t> flushed_rows;
+    std::atomic<size_t> coalesced_writes;
+    std::atomic<size_t> failed_flushes;
+    std::atomic<size_t> backpressure_waits;
+    std::atomic<size_t> dropped_rows;
+    std::atomic<uint64_t> total_flush_us;
+    std::atomic<uint64_t> max_flush_us;
+
+    // 写出一批取出的行，返回是否全部成功。失败的行在没有更新的值时放回缓冲区
+    bool writeOut(Batch& rows) {
+        bool all_ok = true;
+        for (size_t begin = 0; begin < rows.size(); begin += max_batch) {
+            size_t end = std::min(begin + max_batch, rows.size());
+            Batch chunk(std::make_move_iterator(rows.begin() + begin), std::make_move_iterator(rows.begin() + end));
+
+            auto start = std::chrono::steady_clock::now();
+            bool ok = flusher(chunk);
+            uint64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            total_flush_us += us;
+            uint64_t previous_max = max_flush_us.load();
+            while (us > previous_max && !max_flush_us.compare_exchange_weak(previous_max, us)) {
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            in_flight -= chunk.size();
+            if (ok) {
+                flush_count++;
+                flushed_rows += chunk.size();
+            } else {
+                all_ok = false;
+                failed_flushes++;
+                for (auto& row : chunk) {
+                    if (dirty_index.find(row.first) == dirty_index.end()) {
+                        if (dirty.empty()) {
+                            oldest_write = std::chrono::steady_clock::now();
+                        }
+                        dirty_index[row.first] = dirty.size();
+                        dirty.push_back(std::move(row));
+                    }
+                }
+            }
+            space_ready.notify_all();
+        }
+        return all_ok;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            if (dirty.empty()) {
+                if (stopping) {
+                    break;
+                }
+                work_ready.wait(lock);
+                continue;
+            }
+            // 未达到max_batch、最早的写入未超时、没有线程在等flush()且未停止时继续等待
+            if (dirty.size() < max_batch && !stopping && waiting_flushers == 0) {
+                auto deadline = oldest_write + max_delay;
+                if (std::chrono::steady_clock::now() < deadline) {
+                    work_ready.wait_until(lock, deadline);
+                    continue;
+                }
+            }
+
+            // 整体取出缓冲区，写出期间新的写入进入新的缓冲区
+            Batch rows;
+            rows.swap(dirty);
+            dirty_index.clear();
+            in_flight += rows.size();
+            uint64_t generation = accepted_generation;
+            uint64_t attempt = ++write_attempts;
+            lock.unlock();
+
+            bool ok = writeOut(rows);
+
+            lock.lock();
+            if (ok) {
+                flushed_generation = generation;
+                consecutive_failures = 0;
+            } else {
+                failed_attempt = attempt;
+                if (++consecutive_failures >= kShutdownRetries && stopping) {
+                    // 停止时后端持续失败，放弃剩余的行，避免析构永远阻塞
+                    dropped_rows += dirty.size();
+                    dirty.clear();
+                    dirty_index.clear();
+                } else if (!stopping) {
+                    // 先通知等待flush()的线程本次失败，再等待一段时间重试
+                    flush_done.notify_all();
+                    work_ready.wait_for(lock, max_delay);
+                }
+            }
+            flush_done.notify_all();
+        }
+        flushed_generation = accepted_generation;
+        flush_done.notify_all();
+    }
+
+public:
+    WriteBehindBuffer(Flusher f, size_t batch, std::chrono::milliseconds delay, size_t pending_limit)
+        : flusher(std::move(f)),
+          max_batch(std::max(batch, size_t(1))),
+          max_pending(std::max(pending_limit, max_batch)),
+          max_delay(delay),
+          in_flight(0),
+          accepted_generation(0),
+          flushed_generation(0),
+          write_attempts(0),
+          failed_attempt(0),
+          stopping(false),
+          waiting_flushers(0),
+          consecutive_failures(0),
+          flush_count(0),
+          flushed_rows(0),
+          coalesced_writes(0),
+          failed_flushes(0),
+          backpressure_waits(0),
+          dropped_rows(0),
+          total_flush_us(0),
+          max_flush_us(0) {
+        worker = std::thread(&WriteBehindBuffer::run, this);
+    }
+
+    WriteBehindBuffer(const WriteBehindBuffer&) = delete;
+    WriteBehindBuffer& operator=(const WriteBehindBuffer&) = delete;
+
+    // 停止前写出所有已接受的写入
+    ~WriteBehindBuffer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            // 停止前的失败不计入停止时的重试次数
+            consecutive_failures = 0;
+        }
+        work_ready.notify_all();
+        worker.join();
+    }
+
+    // 记录一次写入。键已在缓冲区中时直接覆盖值；缓冲区已满时阻塞到后台线程写出一批
+    template<typename K, typename V>
+    void write(K&& key, V&& value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            auto it = dirty_index.find(key);
+            if (it != dirty_index.end()) {
+                dirty[it->second].second = std::forward<V>(value);
+                coalesced_writes++;
+                accepted_generation++;
+                return;
+            }
+            if (dirty.size() + in_flight < max_pending) {
+                break;
+            }
+            // 等待期间其他线程可能写入了同一个键，醒来后重新查找
+            backpressure_waits++;
+            work_ready.notify_one();
+            space_ready.wait(lock, [this]() { return dirty.size() + in_flight < max_pending; });
+        }
+
+        if (dirty.empty()) {
+            oldest_write = std::chrono::steady_clock::now();
+        }
+        dirty.emplace_back(std::string(std::forward<K>(key)), std::forward<V>(value));
+        dirty_index[dirty.back().first] = dirty.size() - 1;
+        accepted_generation++;
+        if (dirty.size() >= max_batch) {
+            work_ready.notify_one();
+        }
+    }
+
+    // 阻塞到调用前接受的所有写入都已写出，返回true；调用之后开始的一次写出失败时返回false(失败的行仍会重试)
+    bool flush() {
+        return flushUntil(std::chrono::steady_clock::time_point::max());
+    }
+
+    // 同flush()，超过timeout仍未写出时返回false
+    bool flush(std::chrono::milliseconds timeout) {
+        return flushUntil(std::chrono::steady_clock::now() + timeout);
+    }
+
+private:
+    bool flushUntil(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> lock(mutex);
+        uint64_t target = accepted_generation;
+        if (flushed_generation >= target) {
+            return true;
+        }
+        // 只看调用之后开始的写出：正在进行的写出可能不包含全部目标写入，失败时等下一次重试
+        uint64_t first_attempt = write_attempts + 1;
+        waiting_flushers++;
+        work_ready.notify_one();
+        auto done = [&]() { return flushed_generation >= target || failed_attempt >= first_attempt; };
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            flush_done.wait(lock, done);
+        } else {
+            flush_done.wait_until(lock, deadline, done);
+        }
+        waiting_flushers--;
+        return flushed_generation >= target;
+    }
+
+public:
+    // 缓冲区中和正在写出的行数
+    size_t queueDepth() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dirty.size() + in_flight;
+    }
+
+    size_t flushCount() const {
+        return flush_count.load();
+    }
+
+    size_t flushedRows() const {
+        return flushed_rows.load();
+    }
+
+    // 被同一个键后续写入覆盖、因而省下的行数
+    size_t coalescedWrites() const {
+        return coalesced_writes.load();
+    }
+
+    size_t failedFlushes() const {
+        return failed_flushes.load();
+    }
+
+    size_t backpressureWaits() const {
+        return backpressure_waits.load();
+    }
+
+    // 停止时后端持续失败而放弃的行数
+    size_t droppedRows() const {
+        return dropped_rows.load();
+    }
+
+    double avgFlushMicros() const {
+        size_t batches = flush_count.load() + failed_flushes.load();
+        return batches ? static_cast<double>(total_flush_us.load()) / batches : 0.0;
+    }
+
+    uint64_t maxFlushMicros() const {
+        return max_flush_us.load();
+    }
+};
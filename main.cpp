@@ -1,129 +1,66 @@
 #include <iostream>
 #include <chrono>
+#include <cmath>
 #include <random>
-#include <mysql/mysql.h>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iomanip>
 #include <sstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <unordered_map>
+#include <list>
+#include <memory>
+#include <optional>
+#include <cstring>
+#include <fstream>
+#include "AdaptiveCache.h"
 #include "ARCCache.h"
+#include "Cache.h"
+#include "CacheSnapshot.h"
+#include "ClockCache.h"
+#include "ClockProCache.h"
+#include "ExpiringCache.h"
 #include "FifoCache.h"
+#include "FlatHashMap.h"
+#include "InMemoryStore.h"
+#include "KeyCodec.h"
+#include "LatencyHistogram.h"
 #include "LFUCache.h"
+#include "LegacyARCCache.h"
+#include "LoadingCache.h"
 #include "LRUCache.h"
+#include "MissRatioCurve.h"
+#include "MySQLDB.h"
+#include "PooledLRUCache.h"
+#include "ShardedCache.h"
+#include "SlabLRUCache.h"
+#include "TinyLFUCache.h"
+#include "TraceFile.h"
+#include "TwoTierCache.h"
+#include "Workload.h"
+#include "WriteBehindBuffer.h"
+#include "AllocCounter.h"
 
 
-// MySQL数据库连接类
-class MySQLDB {
-private:
-    MYSQL* connection;
-    
-public:
-    MySQLDB() : connection(nullptr) {}
-    
-    bool connect(const std::string& host, const std::string& user, 
-                 const std::string& password, const std::string& database, int port = 3306) {
-        connection = mysql_init(nullptr);
-        if (!connection) {
-            std::cerr << "MySQL initialization failed" << std::endl;
-            return false;
-        }
-        
-        if (!mysql_real_connect(connection, host.c_str(), user.c_str(), 
-                               password.c_str(), database.c_str(), port, nullptr, 0)) {
-            std::cerr << "MySQL connection failed: " << mysql_error(connection) << std::endl;
-            return false;
-        }
-        
-        std::cout << "Connected to MySQL database successfully!" << std::endl;
-        return true;
-    }
-    
-    bool executeQuery(const std::string& query, std::vector<std::vector<std::string>>& results) {
-        if (mysql_query(connection, query.c_str())) {
-            std::cerr << "Query execution failed: " << mysql_error(connection) << std::endl;
-            return false;
-        }
-        
-        MYSQL_RES* result = mysql_store_result(connection);
-        if (!result) {
-            return true; // 查询成功但无结果(如INSERT, UPDATE等)
-        }
-        
-        int num_fields = mysql_num_fields(result);
-        MYSQL_ROW row;
-        
-        while ((row = mysql_fetch_row(result))) {
-            std::vector<std::string> row_data;
-            for (int i = 0; i < num_fields; i++) {
-                row_data.push_back(row[i] ? row[i] : "NULL");
-            }
-            results.push_back(row_data);
-        }
-        
-        mysql_free_result(result);
-        return true;
-    }
-    
-    // 模拟从数据库获取数据的方法
-    bool getData(const std::string& key, std::string& value) {
-        std::vector<std::vector<std::string>> results;
-        std::string query = "SELECT cache_value FROM cache_test WHERE cache_key = '" + key + "'";
-        
-        if (executeQuery(query, results) && !results.empty()) {
-            value = results[0][0];
-            return true;
-        }
-        return false;
-    }
-    
-    // 模拟向数据库插入数据的方法
-    bool putData(const std::string& key, const std::string& value) {
-        std::string query = "INSERT INTO cache_test (cache_key, cache_value) VALUES ('" + key + "', '" + value + "') "
-                           "ON DUPLICATE KEY UPDATE cache_value = '" + value + "'";
-        std::vector<std::vector<std::string>> results;
-        return executeQuery(query, results);
-    }
-    
-    ~MySQLDB() {
-        if (connection) {
-            mysql_close(connection);
-        }
-    }
-};
-
 // 缓存性能测试类
 class CachePerformanceTest {
 public:
+    // 访问序列在调用前生成，计时循环中不调用随机数生成器
     template<typename CacheType>
     static void testCache(CacheType& cache, const std::string& cache_name, 
                          const std::vector<std::pair<std::string, std::string>>& test_data,
-                         int iterations) {
-        std::cout << "\n=== Testing " << cache_name << " Cache ===" << std::endl;
+                         const Workload& workload) {
+        std::cout << "\n=== Testing " << cache_name << " Cache (" << workload.name << ") ===" << std::endl;
         
+        int iterations = static_cast<int>(workload.indices.size());
         auto start_time = std::chrono::high_resolution_clock::now();
         int hits = 0, misses = 0;
         
-        // 测试数据访问 - 创建更真实的访问模式
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        // 80% 的访问集中在20%的数据上(二八定律)
-        std::uniform_int_distribution<> dis(0, test_data.size() - 1);
-        std::discrete_distribution<> access_dist({80, 20}); // 80% 时间访问热数据
-        
-        // 定义热数据范围(前20%)
-        size_t hot_data_size = test_data.size() / 5;
-        
-        for (int i = 0; i < iterations; i++) {
-            int index;
-            // 根据分布决定访问热数据还是冷数据
-            if (access_dist(gen) == 0) {
-                // 访问热数据(前20%)
-                index = dis(gen) % hot_data_size;
-            } else {
-                // 访问冷数据(后80%)
-                index = hot_data_size + (dis(gen) % (test_data.size() - hot_data_size));
-            }
-            
+        for (int index : workload.indices) {
             // 替换结构化绑定为传统方式
             const std::string& key = test_data[index].first;
             const std::string& value = test_data[index].second;
@@ -147,35 +84,847 @@ public:
         std::cout << "Time taken: " << duration.count() << " microseconds" << std::endl;
         std::cout << "Cache size: " << cache.size() << std::endl;
     }
-    
+
+    // 淘汰开销随容量的变化：先填满缓存，再统计每次未命中插入(必然触发淘汰)的平均耗时
+    template<typename CacheType>
+    static void testEvictionScaling(const std::string& cache_name, const std::vector<size_t>& capacities,
+                                    int evictions) {
+        std::cout << "\n=== Eviction Cost Scaling (" << cache_name << ") ===" << std::endl;
+
+        for (size_t cap : capacities) {
+            CacheType cache(cap);
+            for (size_t i = 0; i < cap; i++) {
+                cache.put("fill_" + std::to_string(i), "value");
+            }
+
+            std::vector<std::string> keys;
+            keys.reserve(evictions);
+            for (int i = 0; i < evictions; i++) {
+                keys.push_back("evict_" + std::to_string(i));
+            }
+
+            auto start_time = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < evictions; i++) {
+                cache.put(keys[i], "value");
+            }
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time);
+
+            std::cout << "Capacity: " << std::setw(8) << cap
+                      << "  Avg evicting put: " << std::fixed << std::setprecision(1)
+                      << static_cast<double>(duration.count()) / evictions << " ns" << std::endl;
+        }
+    }
+
+    // 每次操作的堆分配次数：先把缓存填到稳定状态，再分别统计命中的get和缓存满时插入新键的put
+    template<typename CacheType>
+    static void testAllocations(const std::string& cache_name, size_t capacity, int operations) {
+        CacheType cache(capacity);
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < capacity + operations; i++) {
+            keys.push_back("alloc_key_" + std::to_string(i));
+        }
+        const std::string value = "value_for_alloc_test";
+
+        for (size_t i = 0; i < capacity; i++) {
+            cache.put(keys[i], value);
+        }
+
+        std::string retrieved_value;
+        AllocCounter::Scope get_scope;
+        auto get_start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < operations; i++) {
+            cache.get(keys[i % capacity], retrieved_value);
+        }
+        auto get_end = std::chrono::high_resolution_clock::now();
+        size_t get_allocations = get_scope.count();
+
+        AllocCounter::Scope put_scope;
+        auto put_start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < operations; i++) {
+            cache.put(keys[capacity + i], value);
+        }
+        auto put_end = std::chrono::high_resolution_clock::now();
+        size_t put_allocations = put_scope.count();
+
+        auto get_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(get_end - get_start).count();
+        auto put_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(put_end - put_start).count();
+        std::cout << std::left << std::setw(12) << cache_name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << static_cast<double>(get_allocations) / operations
+                  << std::setw(12) << static_cast<double>(get_ns) / operations
+                  << std::setw(12) << static_cast<double>(put_allocations) / operations
+                  << std::setw(12) << static_cast<double>(put_ns) / operations << std::endl;
+    }
+
+    // 大值的命中延迟：拷贝出值的get与返回句柄的get对比，键用string_view传入，不构造临时字符串
+    template<typename CacheType>
+    static void testValueAccess(const std::string& cache_name, size_t capacity, size_t value_size, int lookups) {
+        CacheType cache(capacity);
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < capacity; i++) {
+            keys.push_back("value_key_" + std::to_string(i));
+        }
+        for (size_t i = 0; i < capacity; i++) {
+            cache.put(keys[i], std::string(value_size, 'v'));
+        }
+
+        size_t checksum = 0;
+        std::string retrieved_value;
+        auto copy_start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            if (cache.get(std::string_view(keys[i % capacity]), retrieved_value)) {
+                checksum += retrieved_value.size();
+            }
+        }
+        auto copy_end = std::chrono::high_resolution_clock::now();
+
+        auto handle_start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            ValueHandle<std::string> handle = cache.get(std::string_view(keys[i % capacity]));
+            if (handle) {
+                checksum += handle->size();
+            }
+        }
+        auto handle_end = std::chrono::high_resolution_clock::now();
+
+        auto copy_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(copy_end - copy_start).count();
+        auto handle_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(handle_end - handle_start).count();
+        std::cout << std::left << std::setw(12) << cache_name << std::right << std::setw(10) << value_size
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(14) << static_cast<double>(copy_ns) / lookups
+                  << std::setw(14) << static_cast<double>(handle_ns) / lookups
+                  << (checksum == 0 ? " (no hits)" : "") << std::endl;
+    }
+
+    // 值大小差异很大时按给定访问序列回放，记录命中率和回放过程中缓存占用的峰值堆内存
+    template<typename CacheType>
+    static void testWeightedCapacity(const std::string& cache_name, CacheType& cache,
+                                     const std::vector<int>& trace, const std::vector<size_t>& value_sizes) {
+        size_t before = AllocCounter::liveBytes().load();
+        size_t peak_bytes = 0;
+        int hits = 0;
+        for (int index : trace) {
+            std::string key = "weighted_key_" + std::to_string(index);
+            if (cache.get(std::string_view(key))) {
+                hits++;
+            } else {
+                cache.put(std::move(key), std::string(value_sizes[index], 'v'));
+                peak_bytes = std::max(peak_bytes, AllocCounter::liveBytes().load() - before);
+            }
+        }
+
+        std::cout << std::left << std::setw(16) << cache_name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << cache.size() << std::setw(14);
+        // 没有分配计数时不输出峰值
+        if (AllocCounter::enabled()) {
+            std::cout << peak_bytes / (1024.0 * 1024.0);
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::setw(10) << std::setprecision(2) << 100.0 * hits / trace.size() << "%" << std::endl;
+    }
+
+    // TTL过期：先测量命中延迟(命中路径只读粗粒度时钟)，再等待TTL到期，检查过期条目是否都按未命中处理
+    template<typename CacheType>
+    static void testExpiration(const std::string& cache_name, CacheType& cache, size_t entries, int lookups,
+                               std::chrono::milliseconds ttl) {
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < entries; i++) {
+            keys.push_back("ttl_key_" + std::to_string(i));
+            cache.put(keys.back(), "value");
+        }
+
+        std::string retrieved_value;
+        int hits = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            if (cache.get(std::string_view(keys[i % entries]), retrieved_value)) {
+                hits++;
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto hit_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        std::this_thread::sleep_for(ttl + std::chrono::milliseconds(10));
+        int stale_hits = 0;
+        for (size_t i = 0; i < entries; i++) {
+            if (cache.get(std::string_view(keys[i]), retrieved_value)) {
+                stale_hits++;
+            }
+        }
+
+        std::cout << std::left << std::setw(20) << cache_name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << static_cast<double>(hit_ns) / lookups
+                  << std::setw(10) << 100.0 * hits / lookups << "%"
+                  << std::setw(14) << stale_hits << std::setw(10) << cache.size() << std::endl;
+    }
+
+    // 写入延迟：同步逐行写入后端与延迟写缓冲区对比。后端每次调用有固定往返延迟，每行另有少量开销
+    static void testWriteBehind(size_t key_count, int writes, std::chrono::microseconds round_trip) {
+        std::atomic<size_t> backend_calls(0);
+        auto backendWrite = [&](size_t rows) {
+            backend_calls++;
+            std::this_thread::sleep_for(round_trip + std::chrono::microseconds(rows));
+        };
+        std::mt19937 gen(11);
+        std::uniform_int_distribution<size_t> dis(0, key_count - 1);
+        std::vector<std::string> keys;
+        for (int i = 0; i < writes; i++) {
+            keys.push_back("wb_key_" + std::to_string(dis(gen)));
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < keys.size(); i++) {
+            backendWrite(1);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto sync_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        size_t sync_calls = backend_calls.exchange(0);
+
+        WriteBehindBuffer<std::string> buffer([&](const WriteBehindBuffer<std::string>::Batch& rows) {
+            backendWrite(rows.size());
+            return true;
+        }, 100, std::chrono::milliseconds(20), 1000);
+        start = std::chrono::high_resolution_clock::now();
+        for (const std::string& key : keys) {
+            buffer.write(key, "value");
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto buffered_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        buffer.flush();
+        auto drained_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start).count();
+
+        std::cout << "Writes: " << writes << " over " << key_count << " keys, backend round trip: "
+                  << round_trip.count() << " us" << std::endl;
+        std::cout << std::fixed << std::setprecision(2)
+                  << "  Synchronous:  " << static_cast<double>(sync_us) / writes << " us/write, "
+                  << sync_calls << " backend calls" << std::endl
+                  << "  Write-behind: " << static_cast<double>(buffered_us) / writes << " us/write, "
+                  << backend_calls.load() << " backend calls, " << buffer.coalescedWrites() << " coalesced, "
+                  << buffer.backpressureWaits() << " backpressure waits, drained in " << drained_us / 1000.0 << " ms"
+                  << std::endl
+                  << "  Flushes: " << buffer.flushCount() << ", avg " << std::setprecision(1) << buffer.avgFlushMicros()
+                  << " us, max " << buffer.maxFlushMicros() << " us, queue depth " << buffer.queueDepth() << std::endl;
+    }
+
+    // 索引查找延迟：分别测量命中和未命中的平均查找耗时
+    template<typename MapType>
+    static void testIndexLookup(const std::string& index_name, size_t entries, int lookups) {
+        MapType index;
+        std::vector<std::string> present_keys, absent_keys;
+        for (size_t i = 0; i < entries; i++) {
+            present_keys.push_back("index_key_" + std::to_string(i));
+            absent_keys.push_back("absent_key_" + std::to_string(i));
+        }
+        for (size_t i = 0; i < entries; i++) {
+            index[present_keys[i]] = i;
+        }
+
+        // 以固定步长打乱访问顺序，避免顺序访问带来的预取优势
+        size_t stride = 7919;
+        size_t found = 0;
+        auto hit_start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            found += index.find(present_keys[(i * stride) % entries]) != index.end();
+        }
+        auto hit_end = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            found += index.find(absent_keys[(i * stride) % entries]) != index.end();
+        }
+        auto miss_end = std::chrono::high_resolution_clock::now();
+
+        auto hit_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(hit_end - hit_start).count();
+        auto miss_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(miss_end - hit_end).count();
+        std::cout << std::left << std::setw(16) << index_name << std::right << std::setw(10) << entries
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << static_cast<double>(hit_ns) / lookups
+                  << std::setw(12) << static_cast<double>(miss_ns) / lookups
+                  << "  (found " << found << ")" << std::endl;
+    }
+
+    // 用同一访问序列填充ARC缓存，返回缓存持有的堆内存字节数：前一半键访问两次进入T2，之后的新键把条目挤到B1/B2
+    template<typename CacheType>
+    static size_t fillARC(CacheType& cache, const std::vector<std::string>& keys, const std::string& value,
+                          size_t capacity) {
+        size_t before = AllocCounter::liveBytes().load();
+        std::string retrieved_value;
+        for (int pass = 0; pass < 2; pass++) {
+            for (size_t i = 0; i < capacity / 2; i++) {
+                if (!cache.get(keys[i], retrieved_value)) {
+                    cache.put(keys[i], value);
+                }
+            }
+        }
+        for (size_t i = capacity / 2; i < keys.size(); i++) {
+            cache.put(keys[i], value);
+        }
+        return AllocCounter::liveBytes().load() - before;
+    }
+
+    // ARC内存占用：相同capacity和访问序列下，新布局(单索引且索引不复制键、幽灵条目只存键，值随降级释放)与改写前的LegacyARCCache
+    // (四列表四索引、幽灵条目保留值)对比
+    static void testARCMemory(size_t capacity, size_t value_size) {
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < 4 * capacity; i++) {
+            keys.push_back("arc_memory_key_" + std::to_string(i));
+        }
+        const std::string value(value_size, 'v');
+
+        std::cout << "Capacity: " << capacity << ", value size: " << value_size << " bytes" << std::endl;
+        auto report = [capacity](const char* name, size_t bytes, size_t resident, size_t ghosts) {
+            std::cout << std::fixed << std::setprecision(1) << "  " << name << ": " << std::setw(10) << bytes / 1024.0
+                      << " KB, " << static_cast<double>(bytes) / capacity << " bytes per cached entry (resident "
+                      << resident << ", ghosts " << ghosts << ")" << std::endl;
+        };
+        {
+            LegacyARCCache<std::string> cache(capacity);
+            size_t bytes = fillARC(cache, keys, value, capacity);
+            report("Old layout", bytes, cache.size(), cache.ghostSize());
+        }
+        {
+            ARCCache<std::string> cache(capacity);
+            size_t bytes = fillARC(cache, keys, value, capacity);
+            report("New layout", bytes, cache.size(), cache.ghostSize());
+        }
+    }
+
+    // 每个条目的内存占用：放入entries个21字节的键后统计缓存持有的堆内存。
+    // Requested是申请的字节数，Malloc另加上glibc malloc每块的头部和对齐，Blocks是每个条目对应的堆块数
+    template<typename CacheType>
+    static void testMemoryPerEntry(const std::string& cache_name, size_t entries, size_t value_size) {
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < entries; i++) {
+            std::string digits = std::to_string(i);
+            keys.push_back("session:user:" + std::string(8 - std::min<size_t>(digits.size(), 8), '0') + digits);
+        }
+        const std::string value(value_size, 'v');
+
+        size_t before_bytes = AllocCounter::liveBytes().load();
+        size_t before_chunks = AllocCounter::liveChunkBytes().load();
+        size_t before_blocks = AllocCounter::liveBlocks().load();
+        CacheType* cache = new CacheType(entries);
+        for (const std::string& key : keys) {
+            cache->put(key, value);
+        }
+        size_t bytes = AllocCounter::liveBytes().load() - before_bytes;
+        size_t chunks = AllocCounter::liveChunkBytes().load() - before_chunks;
+        size_t blocks = AllocCounter::liveBlocks().load() - before_blocks;
+        size_t stored = cache->size();
+        delete cache;
+
+        std::cout << std::left << std::setw(12) << cache_name << std::right << std::setw(8) << value_size
+                  << std::fixed << std::setprecision(1) << std::setw(12) << static_cast<double>(bytes) / stored
+                  << std::setw(10) << static_cast<double>(chunks) / stored << std::setprecision(2)
+                  << std::setw(10) << static_cast<double>(blocks) / stored << std::endl;
+    }
+
+    // 按给定访问序列回放，未命中时put，返回命中率(%)
+    template<typename CacheType>
+    static double testTraceHitRate(size_t capacity, const std::vector<std::string>& trace) {
+        CacheType cache(capacity);
+        size_t hits = 0;
+        std::string retrieved_value;
+        for (const std::string& key : trace) {
+            if (cache.get(key, retrieved_value)) {
+                hits++;
+            } else {
+                cache.put(key, key);
+            }
+        }
+        return trace.empty() ? 0.0 : hits * 100.0 / trace.size();
+    }
+
+    // 按预先生成的访问序列回放，未命中时put，返回命中率(%)，ns_per_op为平均每次访问的耗时
+    template<typename CacheType>
+    static double testWorkloadHitRate(size_t capacity, const Workload& workload, const std::vector<std::string>& keys,
+                                      double& ns_per_op) {
+        CacheType cache(capacity);
+        size_t hits = 0;
+        std::string retrieved_value;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int index : workload.indices) {
+            if (cache.get(keys[index], retrieved_value)) {
+                hits++;
+            } else {
+                cache.put(keys[index], keys[index]);
+            }
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        ns_per_op = workload.indices.empty() ? 0.0 :
+            static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()) /
+            workload.indices.size();
+        return workload.indices.empty() ? 0.0 : hits * 100.0 / workload.indices.size();
+    }
+
+    // 与testWorkloadHitRate相同，但键和值的类型由缓存决定：keys[i]是第i个键，值为键的下标
+    template<typename CacheType, typename KeyType>
+    static double testKeyedHitRate(size_t capacity, const Workload& workload, const std::vector<KeyType>& keys,
+                                   double& ns_per_op) {
+        CacheType cache(capacity);
+        size_t hits = 0;
+        uint64_t retrieved_value = 0;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int index : workload.indices) {
+            if (cache.get(keys[index], retrieved_value)) {
+                hits++;
+            } else {
+                cache.put(keys[index], static_cast<uint64_t>(index));
+            }
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        ns_per_op = workload.indices.empty() ? 0.0 :
+            static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()) /
+            workload.indices.size();
+        return workload.indices.empty() ? 0.0 : hits * 100.0 / workload.indices.size();
+    }
+
+    struct ReplayResult {
+        size_t requests = 0;
+        size_t hits = 0;
+        uint64_t request_bytes = 0;
+        uint64_t hit_bytes = 0;
+        long long duration_ns = 0;
+    };
+
+    // 回放映射的trace文件，未命中时put。容量按条目数计，值用很短的字符串，对象字节数只用于统计字节命中率。
+    // 键是8字节的键id，std::string的短字符串优化使其不分配堆内存
+    template<typename CacheType>
+    static ReplayResult testTraceReplay(const MappedTrace& trace, size_t capacity) {
+        CacheType cache(capacity);
+        ReplayResult result;
+        std::string key(sizeof(uint64_t), '\0');
+        const std::string value = "v";
+        std::string retrieved_value;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (const TraceRecord& record : trace) {
+            uint64_t id = record.key();
+            std::memcpy(&key[0], &id, sizeof(id));
+            result.request_bytes += record.size();
+            if (cache.get(key, retrieved_value)) {
+                result.hits++;
+                result.hit_bytes += record.size();
+            } else {
+                cache.put(key, value);
+            }
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        result.requests = trace.size();
+        result.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+        return result;
+    }
+
+    // 缺失率曲线：一次遍历用ShardsEstimator预测各容量的LRU命中率，再对几个容量实际回放LRU对比
+    // for_each_key(visitor)对访问序列中的每个键id调用一次visitor(uint64_t)，可以重复遍历
+    template<typename ForEach>
+    static void testMissRatioCurve(size_t max_capacity, size_t budget, ForEach for_each_key) {
+        ShardsEstimator estimator(max_capacity, 100, budget);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for_each_key([&](uint64_t id) {
+            estimator.access(KeyCodec::hashKey(id));
+        });
+        auto end_time = std::chrono::high_resolution_clock::now();
+        auto estimate_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
+
+        std::cout << "Requests: " << estimator.totalRefs() << ", tracked keys: " << estimator.trackedKeys()
+                  << ", sampling rate: " << std::fixed << std::setprecision(4) << estimator.samplingRate()
+                  << ", estimate time: " << estimate_ms << " ms" << std::endl;
+        std::cout << std::left << std::setw(12) << "Capacity" << std::right << std::setw(12) << "Predicted"
+                  << std::setw(12) << "Actual LRU" << std::setw(10) << "Error" << std::endl;
+        for (size_t divisor : {20, 10, 4, 2, 1}) {
+            size_t capacity = max_capacity / divisor;
+            LRUCache<std::string> cache(capacity);
+            std::string key(sizeof(uint64_t), '\0');
+            std::string retrieved_value;
+            size_t hits = 0, requests = 0;
+            for_each_key([&](uint64_t id) {
+                std::memcpy(&key[0], &id, sizeof(id));
+                requests++;
+                if (cache.get(key, retrieved_value)) {
+                    hits++;
+                } else {
+                    cache.put(key, "v");
+                }
+            });
+            double predicted = estimator.hitRate(capacity) * 100;
+            double actual = requests ? hits * 100.0 / requests : 0.0;
+            std::cout << std::left << std::setw(12) << capacity << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(11) << predicted << "%" << std::setw(11) << actual << "%"
+                      << std::setw(9) << std::abs(predicted - actual) << "%" << std::endl;
+        }
+    }
+
+    // 多线程吞吐测试：对每种分片数和线程数组合，所有线程同时对同一个ShardedCache执行get/put
+    template<typename CacheType>
+    static void testConcurrentCache(const std::string& cache_name, size_t capacity,
+                                    const std::vector<std::pair<std::string, std::string>>& test_data,
+                                    const std::vector<size_t>& shard_counts,
+                                    const std::vector<int>& thread_counts, int ops_per_thread) {
+        std::cout << "\n=== Concurrent Throughput (" << cache_name << ") ===" << std::endl;
+        std::cout << std::setw(8) << "Shards" << std::setw(10) << "Threads"
+                  << std::setw(14) << "Mops/s" << std::setw(12) << "Hit Rate" << std::endl;
+
+        for (size_t shard_count : shard_counts) {
+            for (int thread_count : thread_counts) {
+                ShardedCache<CacheType> cache(capacity, shard_count);
+
+                // 预先生成每个线程的访问序列，随机数开销不计入测试时间
+                std::vector<std::vector<int>> streams(thread_count);
+                for (int t = 0; t < thread_count; t++) {
+                    streams[t] = generateAccessPattern(test_data.size(), ops_per_thread, t + 1);
+                }
+
+                std::atomic<bool> start(false);
+                std::atomic<long> total_hits(0);
+                std::vector<std::thread> workers;
+                for (int t = 0; t < thread_count; t++) {
+                    workers.emplace_back([&, t]() {
+                        while (!start.load(std::memory_order_acquire)) {
+                            std::this_thread::yield();
+                        }
+                        long hits = 0;
+                        std::string retrieved_value;
+                        for (int index : streams[t]) {
+                            if (cache.get(test_data[index].first, retrieved_value)) {
+                                hits++;
+                            } else {
+                                cache.put(test_data[index].first, test_data[index].second);
+                            }
+                        }
+                        total_hits += hits;
+                    });
+                }
+
+                auto start_time = std::chrono::high_resolution_clock::now();
+                start.store(true, std::memory_order_release);
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+                auto end_time = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+
+                double total_ops = static_cast<double>(ops_per_thread) * thread_count;
+                std::cout << std::setw(8) << shard_count << std::setw(10) << thread_count
+                          << std::setw(14) << std::fixed << std::setprecision(2)
+                          << total_ops / std::max<long>(duration.count(), 1)
+                          << std::setw(11) << total_hits * 100.0 / total_ops << "%" << std::endl;
+            }
+        }
+    }
+
+    // 缓存冷启动时多个线程同时请求同一批热点键：对比调用方自己get -> 查询后端 -> put，
+    // 与LoadingCache合并并发未命中。后端用固定延迟模拟一次数据库查询
+    static void testLoadCoalescing(size_t hot_keys, int thread_count, std::chrono::microseconds backend_latency) {
+        std::atomic<size_t> backend_queries(0);
+        auto backend = [&](const std::string& key, std::string& value) {
+            backend_queries++;
+            std::this_thread::sleep_for(backend_latency);
+            value = "value_for_" + key;
+            return true;
+        };
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < hot_keys; i++) {
+            keys.push_back("hot_key_" + std::to_string(i));
+        }
+
+        auto run = [&](auto& cache, auto lookup) {
+            backend_queries = 0;
+            std::atomic<bool> go(false);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < thread_count; t++) {
+                threads.emplace_back([&]() {
+                    while (!go.load()) {
+                        std::this_thread::yield();
+                    }
+                    std::string value;
+                    for (const std::string& key : keys) {
+                        lookup(cache, key, value);
+                    }
+                });
+            }
+            auto start = std::chrono::high_resolution_clock::now();
+            go = true;
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        };
+
+        ShardedCache<LRUCache<std::string>> plain_cache(hot_keys * 2, 16);
+        auto plain_ms = run(plain_cache, [&](ShardedCache<LRUCache<std::string>>& cache, const std::string& key,
+                                             std::string& value) {
+            if (!cache.get(key, value)) {
+                backend(key, value);
+                cache.put(key, value);
+            }
+        });
+        size_t plain_queries = backend_queries.load();
+
+        LoadingCache<std::string> loading_cache(backend, hot_keys * 2, size_t(16));
+        auto loading_ms = run(loading_cache, [](LoadingCache<std::string>& cache, const std::string& key,
+                                                std::string& value) {
+            cache.get(key, value);
+        });
+
+        std::cout << "Threads: " << thread_count << ", hot keys: " << hot_keys
+                  << ", backend latency: " << backend_latency.count() << " us" << std::endl;
+        std::cout << "  get/query/put:  " << std::setw(6) << plain_queries << " backend queries, "
+                  << plain_ms << " ms" << std::endl;
+        std::cout << "  LoadingCache:   " << std::setw(6) << loading_cache.loadCount() << " backend queries, "
+                  << loading_ms << " ms, " << loading_cache.savedLoads() << " queries saved" << std::endl;
+    }
+
+    // 端到端未命中代价：LoadingCache + InMemoryStore，多线程按80/20分布读取，统计每次get的延迟分布
+    // 再用同一个后端对比冷缓存下逐键加载与一次批量加载100个键
+    static void testMissCost(const std::string& model_name, const LatencyModel& model, int thread_count,
+                             int ops_per_thread) {
+        const size_t KEY_COUNT = 10000;
+        const size_t CACHE_CAPACITY = 1000;
+        InMemoryStore store(model, 32);
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < KEY_COUNT; i++) {
+            keys.push_back("key_" + std::to_string(i));
+            store.load(keys.back(), "value_for_" + keys.back());
+        }
+
+        auto loader = [&store](const std::string& key, std::string& value) {
+            return store.getData(key, value);
+        };
+        LoadingCache<std::string> cache(loader, CACHE_CAPACITY, size_t(16));
+        std::vector<std::vector<long long>> latencies(thread_count);
+        std::vector<std::thread> threads;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&, t]() {
+                std::vector<int> indices = generateAccessPattern(KEY_COUNT, ops_per_thread, 1000 + t);
+                latencies[t].reserve(indices.size());
+                std::string value;
+                for (int index : indices) {
+                    auto op_start = std::chrono::steady_clock::now();
+                    cache.get(keys[index], value);
+                    latencies[t].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - op_start).count());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        std::vector<long long> all;
+        for (auto& per_thread : latencies) {
+            all.insert(all.end(), per_thread.begin(), per_thread.end());
+        }
+        std::sort(all.begin(), all.end());
+        double mean_ns = 0;
+        for (long long ns : all) {
+            mean_ns += ns;
+        }
+        mean_ns /= all.size();
+        long long p99_ns = all[all.size() * 99 / 100];
+
+        // 冷缓存下100个键：逐键加载与一次批量加载
+        std::vector<std::string> batch(keys.end() - 100, keys.end());
+        std::vector<std::optional<std::string>> values;
+        LoadingCache<std::string> per_key_cache(loader, batch.size(), size_t(1));
+        auto batch_start = std::chrono::high_resolution_clock::now();
+        per_key_cache.getMany(batch, values);
+        auto per_key_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - batch_start).count();
+        LoadingCache<std::string> batched_cache(loader, batch.size(), size_t(1));
+        batched_cache.setBatchLoader([&store](const std::vector<std::string>& batch_keys,
+                                              std::vector<std::pair<std::string, std::string>>& found) {
+            return store.getDataBatch(batch_keys, found);
+        });
+        batch_start = std::chrono::high_resolution_clock::now();
+        batched_cache.getMany(batch, values);
+        auto batched_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - batch_start).count();
+
+        std::cout << std::left << std::setw(22) << model_name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << (1.0 - static_cast<double>(cache.loadCount()) / all.size()) * 100 << "%"
+                  << std::setw(12) << std::setprecision(1) << mean_ns / 1000
+                  << std::setw(12) << p99_ns / 1000.0
+                  << std::setw(10) << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()
+                  << std::setw(14) << per_key_us << std::setw(14) << batched_us << std::endl;
+    }
+
+    // 多线程读吞吐测试：缓存能容纳全部热数据，绝大多数操作是命中的get，未命中时再put
+    // CacheType本身必须是线程安全的(ShardedCache或自带锁的CLOCK缓存)
+    template<typename CacheType, typename... Args>
+    static void testReadThroughput(const std::string& cache_name,
+                                   const std::vector<std::pair<std::string, std::string>>& test_data,
+                                   const std::vector<int>& thread_counts, int ops_per_thread, Args... cache_args) {
+        std::cout << std::left << std::setw(16) << cache_name << std::right;
+        for (int thread_count : thread_counts) {
+            CacheType cache(cache_args...);
+            std::vector<std::vector<int>> streams(thread_count);
+            for (int t = 0; t < thread_count; t++) {
+                streams[t] = generateAccessPattern(test_data.size(), ops_per_thread, t + 1);
+            }
+            // 预热：先载入全部热数据
+            for (size_t i = 0; i < test_data.size() / 5; i++) {
+                cache.put(test_data[i].first, test_data[i].second);
+            }
+
+            std::atomic<bool> start(false);
+            std::vector<std::thread> workers;
+            for (int t = 0; t < thread_count; t++) {
+                workers.emplace_back([&, t]() {
+                    while (!start.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    std::string retrieved_value;
+                    for (int index : streams[t]) {
+                        if (!cache.get(test_data[index].first, retrieved_value)) {
+                            cache.put(test_data[index].first, test_data[index].second);
+                        }
+                    }
+                });
+            }
+
+            auto start_time = std::chrono::high_resolution_clock::now();
+            start.store(true, std::memory_order_release);
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            auto end_time = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+
+            double total_ops = static_cast<double>(ops_per_thread) * thread_count;
+            std::cout << std::setw(10) << std::fixed << std::setprecision(2)
+                      << total_ops / std::max<long>(duration.count(), 1);
+        }
+        std::cout << std::endl;
+    }
+
+    enum LatencyOp { GetHit, GetMiss, EvictingPut, Put, kLatencyOps };
+
+    // 固定时长的多线程延迟测试：每个线程按Zipf(0.9)访问，read_percent%的操作为get(未命中时put，
+    // 缓存已满，这次put必然淘汰)，其余为直接put。每次操作的耗时记入线程自己的直方图，结束后合并。
+    // json为true时每种操作输出一行JSON，否则输出表格行
+    template<typename CacheType, typename... Args>
+    static void testLatency(const std::string& cache_name, const std::vector<std::string>& keys, size_t capacity,
+                            int thread_count, int read_percent, std::chrono::milliseconds duration, bool json,
+                            Args... cache_args) {
+        static const char* const kOpNames[kLatencyOps] = {"get_hit", "get_miss", "evicting_put", "put"};
+        const int STREAM_LENGTH = 1 << 20;
+
+        CacheType cache(cache_args...);
+        for (size_t i = 0; i < capacity; i++) {
+            cache.put(keys[i], keys[i]);
+        }
+        // 访问序列和读写选择在计时前生成，线程循环使用
+        std::vector<Workload> streams;
+        std::vector<std::vector<bool>> is_read(thread_count);
+        for (int t = 0; t < thread_count; t++) {
+            streams.push_back(Workloads::zipf(keys.size(), STREAM_LENGTH, 0.9, 100 + t));
+            std::mt19937 gen(200 + t);
+            std::uniform_int_distribution<> percent(0, 99);
+            is_read[t].resize(STREAM_LENGTH);
+            for (int i = 0; i < STREAM_LENGTH; i++) {
+                is_read[t][i] = percent(gen) < read_percent;
+            }
+        }
+
+        std::vector<std::vector<LatencyHistogram>> histograms(thread_count, std::vector<LatencyHistogram>(kLatencyOps));
+        std::atomic<bool> start(false);
+        std::chrono::steady_clock::time_point deadline;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < thread_count; t++) {
+            workers.emplace_back([&, t]() {
+                while (!start.load(std::memory_order_acquire)) {
+                    std::this_thread::yield();
+                }
+                std::vector<LatencyHistogram>& hist = histograms[t];
+                const std::vector<int>& indices = streams[t].indices;
+                std::string retrieved_value;
+                auto elapsedNs = [](std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+                    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+                };
+                auto now = std::chrono::steady_clock::now();
+                for (size_t i = 0; now < deadline; i = (i + 1) % indices.size()) {
+                    const std::string& key = keys[indices[i]];
+                    auto op_start = now;
+                    if (is_read[t][i]) {
+                        bool hit = cache.get(key, retrieved_value);
+                        now = std::chrono::steady_clock::now();
+                        hist[hit ? GetHit : GetMiss].record(elapsedNs(op_start, now));
+                        if (!hit) {
+                            op_start = now;
+                            cache.put(key, key);
+                            now = std::chrono::steady_clock::now();
+                            hist[EvictingPut].record(elapsedNs(op_start, now));
+                        }
+                    } else {
+                        cache.put(key, key);
+                        now = std::chrono::steady_clock::now();
+                        hist[Put].record(elapsedNs(op_start, now));
+                    }
+                }
+            });
+        }
+        deadline = std::chrono::steady_clock::now() + duration;
+        start.store(true, std::memory_order_release);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        std::vector<LatencyHistogram> merged(kLatencyOps);
+        uint64_t total_ops = 0;
+        for (int t = 0; t < thread_count; t++) {
+            for (int op = 0; op < kLatencyOps; op++) {
+                merged[op].merge(histograms[t][op]);
+            }
+        }
+        for (int op = 0; op < kLatencyOps; op++) {
+            total_ops += merged[op].count();
+        }
+        double seconds = std::chrono::duration<double>(duration).count();
+        for (int op = 0; op < kLatencyOps; op++) {
+            const LatencyHistogram& h = merged[op];
+            if (h.count() == 0) {
+                continue;
+            }
+            if (json) {
+                std::cout << "{\"policy\":\"" << cache_name << "\",\"threads\":" << thread_count
+                          << ",\"read_pct\":" << read_percent << ",\"op\":\"" << kOpNames[op]
+                          << "\",\"count\":" << h.count() << ",\"p50_ns\":" << h.percentile(50)
+                          << ",\"p99_ns\":" << h.percentile(99) << ",\"p999_ns\":" << h.percentile(99.9)
+                          << ",\"max_ns\":" << h.max() << ",\"ops_per_sec\":" << std::fixed << std::setprecision(0)
+                          << h.count() / seconds << ",\"total_ops_per_sec\":" << total_ops / seconds << "}" << std::endl;
+            } else {
+                std::cout << std::left << std::setw(12) << cache_name << std::right << std::setw(8) << thread_count
+                          << std::setw(7) << read_percent << "%" << std::setw(14) << kOpNames[op]
+                          << std::setw(12) << h.count() << std::setw(10) << h.percentile(50)
+                          << std::setw(10) << h.percentile(99) << std::setw(10) << h.percentile(99.9)
+                          << std::setw(12) << h.max() << std::setw(10) << std::fixed << std::setprecision(2)
+                          << h.count() / seconds / 1e6 << std::endl;
+            }
+        }
+    }
+
+    // 80%的访问集中在前20%的数据上，返回访问下标序列
+    static std::vector<int> generateAccessPattern(size_t data_size, int count, unsigned seed) {
+        return Workloads::hotCold(data_size, count, seed).indices;
+    }
+
     // 针对数据库访问的缓存测试
     template<typename CacheType>
-    static void testDatabaseCache(CacheType& cache, const std::string& cache_name, MySQLDB& db,
-                                 const std::vector<std::string>& test_keys, int iterations) {
+    // write_behind不为空时，新数据写入缓存后交给延迟写缓冲区，不同步等待INSERT
+    static void testDatabaseCache(CacheType& cache, const std::string& cache_name, BackingStore& db,
+                                 const std::vector<std::string>& test_keys, int iterations,
+                                 WriteBehindBuffer<std::string>* write_behind = nullptr) {
         std::cout << "\n=== Testing " << cache_name << " Cache with Database Access ===" << std::endl;
         
+        // 80% 时间访问前20%的热数据，访问序列在计时前生成
+        std::vector<int> indices = generateAccessPattern(test_keys.size(), iterations, 42);
         auto start_time = std::chrono::high_resolution_clock::now();
         int cache_hits = 0, db_hits = 0, db_misses = 0;
         
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_int_distribution<> dis(0, test_keys.size() - 1);
-        std::discrete_distribution<> access_dist({80, 20}); // 80% 时间访问热数据
-        
-        // 定义热数据范围(前20%)
-        size_t hot_data_size = test_keys.size() / 5;
-        
-        for (int i = 0; i < iterations; i++) {
-            int index;
-            // 根据分布决定访问热数据还是冷数据
-            if (access_dist(gen) == 0) {
-                // 访问热数据(前20%)
-                index = dis(gen) % hot_data_size;
-            } else {
-                // 访问冷数据(后80%)
-                index = hot_data_size + (dis(gen) % (test_keys.size() - hot_data_size));
-            }
-            
+        for (int index : indices) {
             const std::string& key = test_keys[index];
             std::string value;
             
@@ -191,7 +940,11 @@ public:
                 } else {
                     // 数据库中也没有数据，创建新数据
                     value = "value_for_" + key;
-                    db.putData(key, value);
+                    if (write_behind) {
+                        write_behind->write(key, value);
+                    } else {
+                        db.putData(key, value);
+                    }
                     cache.put(key, value);
                     db_misses++;
                 }
@@ -212,6 +965,106 @@ public:
         std::cout << "Total Requests: " << total_requests << std::endl;
         std::cout << "Time taken: " << duration.count() << " microseconds" << std::endl;
         std::cout << "Cache size: " << cache.size() << std::endl;
+        if (write_behind) {
+            if (!write_behind->flush(std::chrono::seconds(5))) {
+                std::cerr << "Write-behind flush failed, " << write_behind->queueDepth() << " rows pending" << std::endl;
+            }
+            std::cout << "Write-behind: " << write_behind->flushCount() << " flushes, "
+                      << write_behind->flushedRows() << " rows, avg flush " << std::fixed << std::setprecision(1)
+                      << write_behind->avgFlushMicros() << " us, max flush " << write_behind->maxFlushMicros()
+                      << " us" << std::endl;
+        }
+    }
+
+    // 快照与热启动：前半段访问预热缓存后保存快照，后半段访问分别在冷缓存和从快照热启动的缓存上运行，
+    // 再完整恢复一次，检查恢复后的策略状态(顺序、频率、所在列表)与保存前一致；
+// 最后在重启后写满的缓存上完整恢复，检查恢复没有淘汰重启后写入的条目
+    template<typename CacheType>
+    static void testSnapshot(const std::string& cache_name, size_t capacity, const Workload& workload,
+                             const std::vector<std::string>& keys, const std::string& path) {
+        typedef std::vector<std::pair<std::string, uint32_t>> EntryOrder;
+        auto entryOrder = [](const CacheType& cache) {
+            EntryOrder order;
+            cache.forEachEntry([&order](std::string_view key, const std::string*, uint32_t meta) {
+                order.emplace_back(std::string(key), meta);
+            });
+            return order;
+        };
+        // 对访问序列的[begin, end)段做读穿透，返回命中率
+        auto replay = [&](auto& cache, size_t begin, size_t end) {
+            size_t hits = 0;
+            std::string value;
+            for (size_t i = begin; i < end; i++) {
+                const std::string& key = keys[workload.indices[i]];
+                if (cache.get(key, value)) {
+                    hits++;
+                } else {
+                    cache.put(key, "value_for_" + key);
+                }
+            }
+            return end > begin ? hits * 100.0 / (end - begin) : 0.0;
+        };
+        auto elapsedMs = [](std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+        const size_t half = workload.indices.size() / 2;
+
+        CacheType original(capacity);
+        replay(original, 0, half);
+        auto start = std::chrono::steady_clock::now();
+        if (!saveSnapshot(original, path)) {
+            return;
+        }
+        double save_ms = elapsedMs(start);
+        MappedSnapshot probe;
+        probe.open(path);
+        size_t records = probe.size();
+        probe.close();
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        double file_mb = file.tellg() / (1024.0 * 1024.0);
+
+        CacheType cold(capacity);
+        double cold_hit_rate = replay(cold, half, workload.indices.size());
+
+        // 只映射快照，不做后台恢复，命中全部来自按需读取
+        start = std::chrono::steady_clock::now();
+        WarmCache<CacheType> warm(path, capacity);
+        double open_ms = elapsedMs(start);
+        std::string value;
+        start = std::chrono::steady_clock::now();
+        warm.get(keys[workload.indices[half]], value);
+        double first_get_us = elapsedMs(start) * 1000;
+        double warm_hit_rate = replay(warm, half + 1, workload.indices.size());
+
+        // 完整恢复，比较策略状态
+        start = std::chrono::steady_clock::now();
+        WarmCache<CacheType> restored(path, capacity);
+        while (restored.restoreStep(10000)) {
+        }
+        double restore_ms = elapsedMs(start);
+        bool identical = entryOrder(restored.underlying()) == entryOrder(original) &&
+                         restored.underlying().policyState() == original.policyState();
+
+        // 重启后先用新的条目写满缓存再完整恢复：恢复只使用空闲容量，重启后写入的条目应全部保留
+        WarmCache<CacheType> busy(path, capacity);
+        for (size_t i = 0; i < capacity; i++) {
+            busy.put("live_" + std::to_string(i), "live");
+        }
+        while (busy.restoreStep(10000)) {
+        }
+        size_t live_kept = 0;
+        for (size_t i = 0; i < capacity; i++) {
+            live_kept += busy.underlying().contains("live_" + std::to_string(i));
+        }
+        std::remove(path.c_str());
+
+        std::cout << std::left << std::setw(8) << cache_name << std::right << std::setw(10) << records
+                  << std::fixed << std::setprecision(1) << std::setw(9) << file_mb << std::setw(10) << save_ms
+                  << std::setw(10) << open_ms << std::setw(12) << first_get_us << std::setprecision(2)
+                  << std::setw(10) << cold_hit_rate << "%" << std::setw(10) << warm_hit_rate << "%"
+                  << std::setprecision(1) << std::setw(12) << restore_ms << std::setw(11)
+                  << (identical ? "yes" : "NO") << std::setw(11) << (live_kept == capacity ? "yes" : "NO")
+                  << std::endl;
     }
 };
 
@@ -248,8 +1101,876 @@ std::vector<std::string> generateTestKeys(int count) {
     return keys;
 }
 
-int main() {
+// 多线程模式：比较不同线程数、分片数下各缓存策略的吞吐
+void runConcurrentTest() {
+    const size_t CACHE_SIZE = 10000;
+    const int OPS_PER_THREAD = 20000;
+    const std::vector<size_t> shard_counts = {1, 4, 16, 64};
+    const std::vector<int> thread_counts = {1, 2, 4, 8, 16, 32};
+
+    std::cout << "Generating test data..." << std::endl;
+    std::vector<std::pair<std::string, std::string>> test_data = generateTestData(100000);
+
+    CachePerformanceTest::testConcurrentCache<FIFOCache<std::string>>("FIFO", CACHE_SIZE, test_data,
+                                                                      shard_counts, thread_counts, OPS_PER_THREAD);
+    CachePerformanceTest::testConcurrentCache<LRUCache<std::string>>("LRU", CACHE_SIZE, test_data,
+                                                                     shard_counts, thread_counts, OPS_PER_THREAD);
+    CachePerformanceTest::testConcurrentCache<LFUCache<std::string>>("LFU", CACHE_SIZE, test_data,
+                                                                     shard_counts, thread_counts, OPS_PER_THREAD);
+    CachePerformanceTest::testConcurrentCache<ARCCache<std::string>>("ARC", CACHE_SIZE, test_data,
+                                                                     shard_counts, thread_counts, OPS_PER_THREAD);
+
+    // 读为主的负载：LRU/ARC每次命中都要独占锁调整链表，CLOCK命中只需读锁
+    const size_t READ_CACHE_SIZE = 30000;
+    std::cout << "\n=== Read Throughput (Mops/s, single instance) ===" << std::endl;
+    std::cout << std::left << std::setw(16) << "Threads" << std::right;
+    for (int thread_count : thread_counts) {
+        std::cout << std::setw(10) << thread_count;
+    }
+    std::cout << std::endl;
+    CachePerformanceTest::testReadThroughput<ShardedCache<LRUCache<std::string>>>(
+        "LRU", test_data, thread_counts, OPS_PER_THREAD, READ_CACHE_SIZE, size_t(1));
+    CachePerformanceTest::testReadThroughput<ShardedCache<ARCCache<std::string>>>(
+        "ARC", test_data, thread_counts, OPS_PER_THREAD, READ_CACHE_SIZE, size_t(1));
+    CachePerformanceTest::testReadThroughput<ClockCache<std::string>>(
+        "CLOCK", test_data, thread_counts, OPS_PER_THREAD, READ_CACHE_SIZE);
+    CachePerformanceTest::testReadThroughput<ClockProCache<std::string>>(
+        "CLOCK-Pro", test_data, thread_counts, OPS_PER_THREAD, READ_CACHE_SIZE);
+
+    // 冷启动时的并发未命中合并
+    std::cout << "\n=== Miss Coalescing (cold cache) ===" << std::endl;
+    CachePerformanceTest::testLoadCoalescing(100, 16, std::chrono::microseconds(500));
+}
+
+// 准入控制对命中率的影响：偏斜访问与夹杂大量一次性扫描的访问
+void runAdmissionTest() {
+    const size_t CACHE_SIZE = 500;
+    const size_t KEY_COUNT = 10000;
+
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+
+    // 偏斜访问：80%的访问落在20%的键上
+    std::vector<std::string> skewed_trace;
+    for (int index : CachePerformanceTest::generateAccessPattern(KEY_COUNT, 200000, 42)) {
+        skewed_trace.push_back(keys[index]);
+    }
+
+    // 扫描访问：每5000次偏斜访问之后插入一段2000个只出现一次的键
+    std::vector<std::string> scan_trace;
+    int scan_id = 0;
+    for (size_t i = 0; i < skewed_trace.size(); i++) {
+        scan_trace.push_back(skewed_trace[i]);
+        if (i % 5000 == 4999) {
+            for (int j = 0; j < 2000; j++) {
+                scan_trace.push_back("scan_" + std::to_string(scan_id++));
+            }
+        }
+    }
+
+    std::cout << "\n=== Admission Control Hit Rate (capacity " << CACHE_SIZE << ") ===" << std::endl;
+    std::cout << std::left << std::setw(16) << "Cache" << std::right
+              << std::setw(12) << "Skewed" << std::setw(12) << "Scan-heavy" << std::endl;
+    auto report = [](const std::string& name, double skewed, double scan) {
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(11) << skewed << "%" << std::setw(11) << scan << "%" << std::endl;
+    };
+    report("LRU",
+           CachePerformanceTest::testTraceHitRate<LRUCache<std::string>>(CACHE_SIZE, skewed_trace),
+           CachePerformanceTest::testTraceHitRate<LRUCache<std::string>>(CACHE_SIZE, scan_trace));
+    report("LRU+TinyLFU",
+           CachePerformanceTest::testTraceHitRate<TinyLFUAdmission<LRUCache<std::string>>>(CACHE_SIZE, skewed_trace),
+           CachePerformanceTest::testTraceHitRate<TinyLFUAdmission<LRUCache<std::string>>>(CACHE_SIZE, scan_trace));
+    report("W-TinyLFU",
+           CachePerformanceTest::testTraceHitRate<TinyLFUCache<std::string>>(CACHE_SIZE, skewed_trace),
+           CachePerformanceTest::testTraceHitRate<TinyLFUCache<std::string>>(CACHE_SIZE, scan_trace));
+    report("ARC",
+           CachePerformanceTest::testTraceHitRate<ARCCache<std::string>>(CACHE_SIZE, skewed_trace),
+           CachePerformanceTest::testTraceHitRate<ARCCache<std::string>>(CACHE_SIZE, scan_trace));
+    report("LFU",
+           CachePerformanceTest::testTraceHitRate<LFUCache<std::string>>(CACHE_SIZE, skewed_trace),
+           CachePerformanceTest::testTraceHitRate<LFUCache<std::string>>(CACHE_SIZE, scan_trace));
+}
+
+// 批量读取测试：同一批键分别用逐个SELECT和一条IN (...)查询加载到冷缓存，需要本地MySQL
+void runBatchTest() {
+    std::cout << "\n=== Batched Multi-Get vs Per-Key Queries ===" << std::endl;
+    MySQLDB db;
+    if (!db.connect("localhost", "ikun", "1234", "cache_test")) {
+        std::cout << "MySQL connection test failed. Please check your MySQL configuration." << std::endl;
+        return;
+    }
+
+    const int KEY_COUNT = 1000;
+    const int ROUNDS = 20;
+    std::vector<std::string> keys = generateTestKeys(KEY_COUNT);
+    for (const std::string& key : keys) {
+        db.putData(key, "value_for_" + key);
+    }
+
+    auto loader = [&db](const std::string& key, std::string& value) {
+        return db.getData(key, value);
+    };
+    auto batch_loader = [&db](const std::vector<std::string>& batch,
+                              std::vector<std::pair<std::string, std::string>>& found) {
+        return db.getDataBatch(batch, found);
+    };
+
+    std::cout << std::left << std::setw(12) << "Batch size" << std::right << std::setw(16) << "Per-key (us)"
+              << std::setw(16) << "Batched (us)" << std::setw(10) << "Speedup" << std::endl;
+    for (size_t batch_size : {50, 100, 500}) {
+        long long per_key_us = 0, batched_us = 0;
+        for (int round = 0; round < ROUNDS; round++) {
+            std::vector<std::string> batch;
+            for (size_t i = 0; i < batch_size; i++) {
+                batch.push_back(keys[(round * batch_size + i) % keys.size()]);
+            }
+            std::vector<std::optional<std::string>> values;
+
+            // 每轮使用新的缓存，保证所有键都未命中
+            LoadingCache<std::string> per_key_cache(loader, batch_size, size_t(1));
+            auto start = std::chrono::high_resolution_clock::now();
+            per_key_cache.getMany(batch, values);
+            auto end = std::chrono::high_resolution_clock::now();
+            per_key_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+            LoadingCache<std::string> batched_cache(loader, batch_size, size_t(1));
+            batched_cache.setBatchLoader(batch_loader);
+            start = std::chrono::high_resolution_clock::now();
+            batched_cache.getMany(batch, values);
+            end = std::chrono::high_resolution_clock::now();
+            batched_us += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        }
+        std::cout << std::left << std::setw(12) << batch_size << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(16) << static_cast<double>(per_key_us) / ROUNDS
+                  << std::setw(16) << static_cast<double>(batched_us) / ROUNDS
+                  << std::setw(9) << (batched_us > 0 ? static_cast<double>(per_key_us) / batched_us : 0.0) << "x"
+                  << std::endl;
+    }
+}
+
+// 数据库读写吞吐：一个加锁共享的MySQLDB与连接池对比(都使用预处理语句，差别只在连接数)，需要本地MySQL
+void runPoolTest() {
+    std::cout << "\n=== MySQL Throughput: Shared Connection vs Connection Pool ===" << std::endl;
+    const size_t POOL_SIZE = 8;
+    const int KEY_COUNT = 1000;
+    const int OPS_PER_THREAD = 2000;
+    const std::vector<int> thread_counts = {1, 2, 4, 8, 16};
+
+    MySQLDB shared_db;
+    MySQLConnectionPool pool;
+    if (!shared_db.connect("localhost", "ikun", "1234", "cache_test")
+        || !pool.connect("localhost", "ikun", "1234", "cache_test", POOL_SIZE)) {
+        std::cout << "MySQL connection test failed. Please check your MySQL configuration." << std::endl;
+        return;
+    }
+    std::vector<std::string> keys = generateTestKeys(KEY_COUNT);
+    for (const std::string& key : keys) {
+        pool.putData(key, "value_for_" + key);
+    }
+
+    // 每个线程执行OPS_PER_THREAD次操作，其中90%读、10%写，返回每秒操作数
+    auto run = [&](int thread_count, auto getData, auto putData) {
+        std::vector<std::thread> threads;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&, t]() {
+                std::mt19937 gen(t + 1);
+                std::uniform_int_distribution<int> dis(0, KEY_COUNT - 1);
+                std::string value;
+                for (int i = 0; i < OPS_PER_THREAD; i++) {
+                    const std::string& key = keys[dis(gen)];
+                    if (i % 10 == 0) {
+                        putData(key, "value_for_" + key);
+                    } else {
+                        getData(key, value);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        return thread_count * OPS_PER_THREAD / seconds;
+    };
+
+    std::mutex shared_mutex;
+    std::cout << std::left << std::setw(10) << "Threads" << std::right << std::setw(20) << "Shared (ops/s)"
+              << std::setw(20) << "Pool (ops/s)" << std::endl;
+    for (int thread_count : thread_counts) {
+        double shared_ops = run(thread_count,
+            [&](const std::string& key, std::string& value) {
+                std::lock_guard<std::mutex> lock(shared_mutex);
+                return shared_db.getData(key, value);
+            },
+            [&](const std::string& key, const std::string& value) {
+                std::lock_guard<std::mutex> lock(shared_mutex);
+                return shared_db.putData(key, value);
+            });
+        double pool_ops = run(thread_count,
+            [&](const std::string& key, std::string& value) { return pool.getData(key, value); },
+            [&](const std::string& key, const std::string& value) { return pool.putData(key, value); });
+        std::cout << std::left << std::setw(10) << thread_count << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(20) << shared_ops << std::setw(20) << pool_ops << std::endl;
+    }
+}
+
+// 延迟分布测试，参数为key=value：seconds=每组的时长，threads=线程数列表，reads=读比例列表(%)，
+// format=table|json。例如 ./main latency seconds=2 threads=1,8 reads=95,50 format=json
+void runLatencyTest(const std::vector<std::string>& args) {
+    double seconds = 1.0;
+    std::vector<int> thread_counts = {1, 4, 8};
+    std::vector<int> read_percents = {95, 50};
+    bool json = false;
+    auto parseList = [](const std::string& text) {
+        std::vector<int> values;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            if (!item.empty()) {
+                values.push_back(std::stoi(item));
+            }
+        }
+        return values;
+    };
+    for (const std::string& arg : args) {
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (name == "seconds") {
+            seconds = std::stod(value);
+        } else if (name == "threads") {
+            thread_counts = parseList(value);
+        } else if (name == "reads") {
+            read_percents = parseList(value);
+        } else if (name == "format") {
+            json = value == "json";
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return;
+        }
+    }
+
+    const size_t CACHE_SIZE = 10000;
+    const size_t KEY_COUNT = 100000;
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+    auto duration = std::chrono::milliseconds(static_cast<long long>(seconds * 1000));
+
+    if (!json) {
+        std::cout << "\n=== Latency Distribution (ns, Zipf 0.9, capacity " << CACHE_SIZE << ") ===" << std::endl;
+        std::cout << std::left << std::setw(12) << "Cache" << std::right << std::setw(8) << "Threads"
+                  << std::setw(8) << "Reads" << std::setw(14) << "Op" << std::setw(12) << "Count"
+                  << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+                  << std::setw(12) << "Max" << std::setw(10) << "Mops/s" << std::endl;
+    }
+    for (int thread_count : thread_counts) {
+        for (int read_percent : read_percents) {
+            CachePerformanceTest::testLatency<ShardedCache<FIFOCache<std::string>>>(
+                "FIFO", keys, CACHE_SIZE, thread_count, read_percent, duration, json, CACHE_SIZE, size_t(16));
+            CachePerformanceTest::testLatency<ShardedCache<LRUCache<std::string>>>(
+                "LRU", keys, CACHE_SIZE, thread_count, read_percent, duration, json, CACHE_SIZE, size_t(16));
+            CachePerformanceTest::testLatency<ShardedCache<LFUCache<std::string>>>(
+                "LFU", keys, CACHE_SIZE, thread_count, read_percent, duration, json, CACHE_SIZE, size_t(16));
+            CachePerformanceTest::testLatency<ShardedCache<ARCCache<std::string>>>(
+                "ARC", keys, CACHE_SIZE, thread_count, read_percent, duration, json, CACHE_SIZE, size_t(16));
+            CachePerformanceTest::testLatency<ClockCache<std::string>>(
+                "CLOCK", keys, CACHE_SIZE, thread_count, read_percent, duration, json, CACHE_SIZE);
+            CachePerformanceTest::testLatency<ClockProCache<std::string>>(
+                "CLOCK-Pro", keys, CACHE_SIZE, thread_count, read_percent, duration, json, CACHE_SIZE);
+        }
+    }
+}
+
+// 缓存自带的统计：同一个访问序列下各策略的计数，ARC的p随热点迁移的变化，以及Prometheus文本格式输出
+void runStatsTest() {
+    const size_t CACHE_SIZE = 1000;
+    const size_t KEY_COUNT = 10000;
+    const int OPS = 200000;
+    const int PHASES = 4;
+    Workload workload = Workloads::phaseShift(KEY_COUNT, OPS, 0.9, PHASES, 11);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+
+    FIFOCache<std::string> fifo_cache(CACHE_SIZE);
+    LRUCache<std::string> lru_cache(CACHE_SIZE);
+    LFUCache<std::string> lfu_cache(CACHE_SIZE);
+    ARCCache<std::string> arc_cache(CACHE_SIZE);
+    std::vector<size_t> arc_p_samples;
+    auto replay = [&](auto& cache, bool sample_p) {
+        std::string value;
+        for (size_t i = 0; i < workload.indices.size(); i++) {
+            const std::string& key = keys[workload.indices[i]];
+            if (!cache.get(key, value)) {
+                cache.put(key, key);
+            }
+            if (sample_p && i % (OPS / 16) == OPS / 16 - 1) {
+                for (const auto& gauge : cache.stats().gauges) {
+                    if (gauge.first == "arc_p") {
+                        arc_p_samples.push_back(static_cast<size_t>(gauge.second));
+                    }
+                }
+            }
+        }
+    };
+    replay(fifo_cache, false);
+    replay(lru_cache, false);
+    replay(lfu_cache, false);
+    replay(arc_cache, true);
+
+    std::vector<std::pair<std::string, CacheStatsSnapshot>> snapshots = {
+        {"FIFO", fifo_cache.stats()}, {"LRU", lru_cache.stats()},
+        {"LFU", lfu_cache.stats()}, {"ARC", arc_cache.stats()}};
+
+    std::cout << "\n=== Cache Statistics (" << workload.name << ", capacity " << CACHE_SIZE << ") ===" << std::endl;
+    if (!CacheStats::enabled()) {
+        std::cout << "Statistics compiled out (CACHE_STATS_ENABLED=0)" << std::endl;
+        return;
+    }
+    std::cout << std::left << std::setw(8) << "Cache" << std::right << std::setw(10) << "Hits" << std::setw(10)
+              << "Misses" << std::setw(10) << "Inserts" << std::setw(10) << "Updates" << std::setw(11) << "Evictions"
+              << std::setw(10) << "B1 hits" << std::setw(10) << "B2 hits" << std::endl;
+    for (const auto& entry : snapshots) {
+        const CacheStatsSnapshot& s = entry.second;
+        std::cout << std::left << std::setw(8) << entry.first << std::right << std::setw(10) << s[kHits]
+                  << std::setw(10) << s[kMisses] << std::setw(10) << s[kInserts] << std::setw(10) << s[kUpdates]
+                  << std::setw(11) << s[kEvictions] << std::setw(10) << s[kGhostHitsB1]
+                  << std::setw(10) << s[kGhostHitsB2] << std::endl;
+    }
+    std::cout << "ARC p every " << OPS / 16 << " ops (hot set moves every " << OPS / PHASES << " ops):";
+    for (size_t p : arc_p_samples) {
+        std::cout << " " << p;
+    }
+    std::cout << std::endl;
+
+    std::cout << "\n--- Prometheus export ---" << std::endl;
+    writePrometheus(std::cout, snapshots);
+}
+
+// 每种策略在每种访问模式下的命中率和每次访问的耗时，访问序列在计时前生成
+void runWorkloadTest() {
+    const size_t CACHE_SIZE = 1000;
+    const size_t KEY_COUNT = 10000;
+    const int OPS = 500000;
+
+    std::vector<Workload> workloads;
+    workloads.push_back(Workloads::uniform(KEY_COUNT, OPS, 1));
+    workloads.push_back(Workloads::hotCold(KEY_COUNT, OPS, 2));
+    workloads.push_back(Workloads::zipf(KEY_COUNT, OPS, 0.8, 3));
+    workloads.push_back(Workloads::zipf(KEY_COUNT, OPS, 1.2, 4));
+    workloads.push_back(Workloads::scanMix(KEY_COUNT, OPS, 0.9, 2 * CACHE_SIZE, 10000, 5));
+    workloads.push_back(Workloads::loop(CACHE_SIZE * 3 / 2, OPS));
+    workloads.push_back(Workloads::phaseShift(KEY_COUNT, OPS, 0.9, 5, 6));
+
+    size_t max_keys = 0;
+    for (const Workload& w : workloads) {
+        max_keys = std::max(max_keys, w.key_count);
+    }
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < max_keys; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+
+    typedef double (*RunFn)(size_t, const Workload&, const std::vector<std::string>&, double&);
+    const std::vector<std::pair<std::string, RunFn>> policies = {
+        {"FIFO", &CachePerformanceTest::testWorkloadHitRate<FIFOCache<std::string>>},
+        {"LRU", &CachePerformanceTest::testWorkloadHitRate<LRUCache<std::string>>},
+        {"LFU", &CachePerformanceTest::testWorkloadHitRate<LFUCache<std::string>>},
+        {"ARC", &CachePerformanceTest::testWorkloadHitRate<ARCCache<std::string>>},
+        {"CLOCK", &CachePerformanceTest::testWorkloadHitRate<ClockCache<std::string>>},
+        {"CLOCK-Pro", &CachePerformanceTest::testWorkloadHitRate<ClockProCache<std::string>>},
+        {"W-TinyLFU", &CachePerformanceTest::testWorkloadHitRate<TinyLFUCache<std::string>>},
+    };
+
+    std::cout << "\n=== Hit Rate by Workload (capacity " << CACHE_SIZE << ", " << OPS << " ops, ns/op) ===" << std::endl;
+    std::cout << std::left << std::setw(18) << "Workload" << std::right;
+    for (const auto& policy : policies) {
+        std::cout << std::setw(18) << policy.first;
+    }
+    std::cout << std::endl;
+    for (const Workload& w : workloads) {
+        std::cout << std::left << std::setw(18) << w.name << std::right;
+        for (const auto& policy : policies) {
+            double ns_per_op = 0;
+            double hit_rate = policy.second(CACHE_SIZE, w, keys, ns_per_op);
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(2) << hit_rate << "% " << std::setprecision(0) << ns_per_op;
+            std::cout << std::setw(18) << cell.str();
+        }
+        std::cout << std::endl;
+    }
+}
+
+// trace回放：每种策略一个线程，同时回放同一个映射的trace文件(只读，共享页缓存)
+void runReplayTest(const std::string& trace_path, size_t capacity) {
+    MappedTrace trace;
+    if (!trace.open(trace_path)) {
+        return;
+    }
+    std::cout << "\n=== Trace Replay (" << trace.size() << " requests, capacity " << capacity << ") ===" << std::endl;
+
+    typedef CachePerformanceTest::ReplayResult (*ReplayFn)(const MappedTrace&, size_t);
+    const std::vector<std::pair<std::string, ReplayFn>> policies = {
+        {"FIFO", &CachePerformanceTest::testTraceReplay<FIFOCache<std::string>>},
+        {"LRU", &CachePerformanceTest::testTraceReplay<LRUCache<std::string>>},
+        {"LFU", &CachePerformanceTest::testTraceReplay<LFUCache<std::string>>},
+        {"ARC", &CachePerformanceTest::testTraceReplay<ARCCache<std::string>>},
+        {"CLOCK", &CachePerformanceTest::testTraceReplay<ClockCache<std::string>>},
+        {"CLOCK-Pro", &CachePerformanceTest::testTraceReplay<ClockProCache<std::string>>},
+        {"W-TinyLFU", &CachePerformanceTest::testTraceReplay<TinyLFUCache<std::string>>},
+    };
+    std::vector<CachePerformanceTest::ReplayResult> results(policies.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < policies.size(); i++) {
+        threads.emplace_back([&, i]() {
+            results[i] = policies[i].second(trace, capacity);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << std::left << std::setw(12) << "Cache" << std::right << std::setw(12) << "Hit rate"
+              << std::setw(16) << "Byte hit rate" << std::setw(14) << "Mops/s" << std::endl;
+    for (size_t i = 0; i < policies.size(); i++) {
+        const CachePerformanceTest::ReplayResult& r = results[i];
+        double hit_rate = r.requests ? r.hits * 100.0 / r.requests : 0.0;
+        double byte_hit_rate = r.request_bytes ? r.hit_bytes * 100.0 / r.request_bytes : 0.0;
+        double mops = r.duration_ns ? r.requests * 1000.0 / r.duration_ns : 0.0;
+        std::cout << std::left << std::setw(12) << policies[i].first << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(11) << hit_rate << "%" << std::setw(15) << byte_hit_rate
+                  << "%" << std::setw(14) << mops << std::endl;
+    }
+}
+
+// 缺失率曲线估计：给出trace文件时用它，否则用80/20的合成访问；最后演示挂在多线程缓存上的监视器
+void runMissRatioCurveTest(const std::string& trace_path, size_t max_capacity) {
+    const size_t SAMPLE_BUDGET = 8192;
+    if (!trace_path.empty()) {
+        MappedTrace trace;
+        if (!trace.open(trace_path)) {
+            return;
+        }
+        std::cout << "\n=== LRU Miss Ratio Curve (SHARDS, trace " << trace_path << ") ===" << std::endl;
+        CachePerformanceTest::testMissRatioCurve(max_capacity, SAMPLE_BUDGET, [&trace](auto visit) {
+            for (const TraceRecord& record : trace) {
+                visit(record.key());
+            }
+        });
+        return;
+    }
+
+    const size_t KEY_COUNT = max_capacity * 4;
+    std::vector<int> indices = CachePerformanceTest::generateAccessPattern(KEY_COUNT, 2000000, 42);
+    std::cout << "\n=== LRU Miss Ratio Curve (SHARDS, 80/20 over " << KEY_COUNT << " keys) ===" << std::endl;
+    CachePerformanceTest::testMissRatioCurve(max_capacity, SAMPLE_BUDGET, [&indices](auto visit) {
+        for (int index : indices) {
+            visit(static_cast<uint64_t>(index));
+        }
+    });
+
+    // 监视器：4个线程读写同一个ShardedCache，运行结束后读出整条曲线
+    const size_t LIVE_CAPACITY = max_capacity / 4;
+    MissRatioMonitor<ShardedCache<LRUCache<std::string>>> monitor(max_capacity, SAMPLE_BUDGET, LIVE_CAPACITY,
+                                                                  size_t(16));
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+    std::atomic<size_t> hits(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t]() {
+            std::string value;
+            for (int index : CachePerformanceTest::generateAccessPattern(KEY_COUNT, 500000, 100 + t)) {
+                if (monitor.get(keys[index], value)) {
+                    hits++;
+                } else {
+                    monitor.put(keys[index], keys[index]);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << "\nMonitor on ShardedCache<LRU> (capacity " << LIVE_CAPACITY << ", 4 threads): actual hit rate "
+              << std::fixed << std::setprecision(2) << hits.load() * 100.0 / 2000000 << "%" << std::endl;
+    std::cout << "Predicted:";
+    for (size_t divisor : {8, 4, 2, 1}) {
+        size_t capacity = max_capacity / divisor;
+        std::cout << "  " << capacity << " -> " << monitor.predictedHitRate(capacity) * 100 << "%";
+    }
+    std::cout << std::endl;
+}
+
+// 不同后端延迟分布下的未命中代价，使用InMemoryStore，不需要MySQL，结果可复现
+void runBackendTest() {
+    std::cout << "\n=== Miss Cost by Backend Latency Model (8 threads, cache 1000 of 10000 keys) ===" << std::endl;
+    std::cout << std::left << std::setw(22) << "Backend" << std::right << std::setw(11) << "Hit rate"
+              << std::setw(12) << "Mean (us)" << std::setw(12) << "p99 (us)" << std::setw(10) << "Total ms"
+              << std::setw(14) << "100 keys (us)" << std::setw(14) << "Batched (us)" << std::endl;
+    const std::chrono::microseconds median(200);
+    CachePerformanceTest::testMissCost("fixed 200us", LatencyModel::fixed(median).withPerRow(std::chrono::microseconds(2)),
+                                       8, 5000);
+    CachePerformanceTest::testMissCost("lognormal 200us", LatencyModel::logNormal(median, 0.8)
+                                       .withPerRow(std::chrono::microseconds(2)), 8, 5000);
+    CachePerformanceTest::testMissCost("lognormal+1% 10ms", LatencyModel::logNormal(median, 0.8)
+                                       .withSpikes(0.01, std::chrono::milliseconds(10))
+                                       .withPerRow(std::chrono::microseconds(2)), 8, 5000);
+}
+
+// 基于策略的Cache模板：与各策略的句柄适配类(FIFOCache等，值为shared_ptr并带统计)对比命中率和耗时，
+// 再看整数键和各可选功能的开销
+void runCompositionTest() {
+    const size_t CACHE_SIZE = 10000;
+    const size_t KEY_COUNT = 100000;
+    Workload workload = Workloads::zipf(KEY_COUNT, 2000000, 0.9, 11);
+    std::vector<std::string> string_keys;
+    std::vector<uint64_t> int_keys;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        string_keys.push_back("key_" + std::to_string(i));
+        int_keys.push_back(i * 2654435761ULL);
+    }
+
+    auto cell = [](double hit_rate, double ns_per_op) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2) << hit_rate << "% " << std::setprecision(0) << ns_per_op;
+        return out.str();
+    };
+    typedef double (*StringRunFn)(size_t, const Workload&, const std::vector<std::string>&, double&);
+    typedef double (*IntRunFn)(size_t, const Workload&, const std::vector<uint64_t>&, double&);
+
+    std::cout << "\n=== Policy-Based Cache (" << workload.name << ", capacity " << CACHE_SIZE << ", "
+              << workload.indices.size() << " ops, ns/op) ===" << std::endl;
+    std::cout << std::left << std::setw(8) << "Policy" << std::right << std::setw(18) << "Class"
+              << std::setw(18) << "Cache<string>" << std::setw(18) << "Cache<uint64_t>" << std::endl;
+    struct PolicyRow {
+        const char* name;
+        StringRunFn standalone;
+        StringRunFn string_keys;
+        IntRunFn int_keys;
+    };
+    const std::vector<PolicyRow> rows = {
+        {"FIFO", &CachePerformanceTest::testKeyedHitRate<FIFOCache<uint64_t>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<std::string, uint64_t, FifoEviction>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<uint64_t, uint64_t, FifoEviction>, uint64_t>},
+        {"LRU", &CachePerformanceTest::testKeyedHitRate<LRUCache<uint64_t>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<std::string, uint64_t, LruEviction>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<uint64_t, uint64_t, LruEviction>, uint64_t>},
+        {"LFU", &CachePerformanceTest::testKeyedHitRate<LFUCache<uint64_t>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<std::string, uint64_t, LfuEviction>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<uint64_t, uint64_t, LfuEviction>, uint64_t>},
+        {"ARC", &CachePerformanceTest::testKeyedHitRate<ARCCache<uint64_t>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<std::string, uint64_t, ArcEviction>, std::string>,
+         &CachePerformanceTest::testKeyedHitRate<Cache<uint64_t, uint64_t, ArcEviction>, uint64_t>},
+    };
+    for (const PolicyRow& row : rows) {
+        double ns_standalone = 0, ns_string = 0, ns_int = 0;
+        double standalone = row.standalone(CACHE_SIZE, workload, string_keys, ns_standalone);
+        double string_hit = row.string_keys(CACHE_SIZE, workload, string_keys, ns_string);
+        double int_hit = row.int_keys(CACHE_SIZE, workload, int_keys, ns_int);
+        std::cout << std::left << std::setw(8) << row.name << std::right << std::setw(18)
+                  << cell(standalone, ns_standalone) << std::setw(18) << cell(string_hit, ns_string)
+                  << std::setw(18) << cell(int_hit, ns_int) << std::endl;
+    }
+
+    // 可选功能的开销：LRU，整数键
+    typedef Cache<uint64_t, uint64_t, LruEviction> Plain;
+    typedef Cache<uint64_t, uint64_t, LruEviction, CacheHash<uint64_t>, std::allocator<uint64_t>, CacheStats> WithStats;
+    typedef Cache<uint64_t, uint64_t, LruEviction, CacheHash<uint64_t>, std::allocator<uint64_t>, NoStats,
+                  TtlExpiry> WithTtl;
+    typedef Cache<uint64_t, uint64_t, LruEviction, CacheHash<uint64_t>, std::allocator<uint64_t>, NoStats,
+                  NoExpiry, std::mutex> WithLock;
+    typedef Cache<uint64_t, uint64_t, LruEviction, CacheHash<uint64_t>, std::allocator<uint64_t>, CacheStats,
+                  TtlExpiry, std::mutex> WithAll;
+    typedef Cache<uint64_t, uint64_t, LruEviction, CacheHash<uint64_t>, SlabStdAllocator<uint64_t>> WithSlab;
+    const std::vector<std::pair<std::string, IntRunFn>> features = {
+        {"none", &CachePerformanceTest::testKeyedHitRate<Plain, uint64_t>},
+        {"stats", &CachePerformanceTest::testKeyedHitRate<WithStats, uint64_t>},
+        {"ttl", &CachePerformanceTest::testKeyedHitRate<WithTtl, uint64_t>},
+        {"mutex", &CachePerformanceTest::testKeyedHitRate<WithLock, uint64_t>},
+        {"stats+ttl+mutex", &CachePerformanceTest::testKeyedHitRate<WithAll, uint64_t>},
+        {"slab allocator", &CachePerformanceTest::testKeyedHitRate<WithSlab, uint64_t>},
+    };
+    std::cout << "\nLRU features (uint64_t keys)" << std::endl;
+    for (const auto& feature : features) {
+        double ns_per_op = 0;
+        double hit_rate = feature.second(CACHE_SIZE, workload, int_keys, ns_per_op);
+        std::cout << std::left << std::setw(18) << feature.first << std::right << std::setw(18)
+                  << cell(hit_rate, ns_per_op) << std::endl;
+    }
+}
+
+// 自适应策略选择：白天是稳定的Zipf点查询，夜间是热集合不断移动的批量访问，两种访问交替两轮。
+// 输出每段中各固定策略和自适应缓存的命中率，以及自适应缓存在每段结束时使用的策略
+void runAdaptiveTest() {
+    const size_t CACHE_SIZE = 10000;
+    const size_t KEY_COUNT = 100000;
+    const int SEGMENT_OPS = 1000000;
+    std::vector<Workload> segments;
+    for (unsigned round = 0; round < 2; round++) {
+        Workload day = Workloads::zipf(KEY_COUNT, SEGMENT_OPS, 0.9, 21 + round);
+        day.name = "day " + std::to_string(round + 1) + " (zipf)";
+        Workload night = Workloads::phaseShift(KEY_COUNT, SEGMENT_OPS, 1.1, 50, 31 + round);
+        night.name = "night " + std::to_string(round + 1) + " (shift)";
+        segments.push_back(std::move(day));
+        segments.push_back(std::move(night));
+    }
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+
+    // 各段依次在同一个缓存上运行，返回每段的命中率
+    auto runSegments = [&](auto& cache, auto after_segment) {
+        std::vector<double> hit_rates;
+        std::string value;
+        for (const Workload& segment : segments) {
+            size_t hits = 0;
+            for (int index : segment.indices) {
+                if (cache.get(keys[index], value)) {
+                    hits++;
+                } else {
+                    cache.put(keys[index], keys[index]);
+                }
+            }
+            hit_rates.push_back(hits * 100.0 / segment.indices.size());
+            after_segment();
+        }
+        return hit_rates;
+    };
+    auto printRow = [](const std::string& name, const std::vector<double>& hit_rates) {
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2);
+        for (double hit_rate : hit_rates) {
+            std::cout << std::setw(18) << hit_rate << "%";
+        }
+        std::cout << std::endl;
+    };
+
+    std::cout << "\n=== Adaptive Policy Selection (capacity " << CACHE_SIZE << ", " << KEY_COUNT << " keys, "
+              << SEGMENT_OPS << " ops per segment) ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "Cache" << std::right;
+    for (const Workload& segment : segments) {
+        std::cout << std::setw(19) << segment.name;
+    }
+    std::cout << std::endl;
+    auto nothing = []() {};
+    {
+        FIFOCache<std::string> cache(CACHE_SIZE);
+        printRow("FIFO", runSegments(cache, nothing));
+    }
+    {
+        LRUCache<std::string> cache(CACHE_SIZE);
+        printRow("LRU", runSegments(cache, nothing));
+    }
+    {
+        LFUCache<std::string> cache(CACHE_SIZE);
+        printRow("LFU", runSegments(cache, nothing));
+    }
+    {
+        ARCCache<std::string> cache(CACHE_SIZE);
+        printRow("ARC", runSegments(cache, nothing));
+    }
+
+    AdaptiveCache<std::string> adaptive(CACHE_SIZE);
+    std::vector<std::string> chosen;
+    printRow("Adaptive", runSegments(adaptive, [&]() { chosen.push_back(adaptive.policy()); }));
+    std::cout << std::left << std::setw(12) << "  policy" << std::right;
+    for (const std::string& name : chosen) {
+        std::cout << std::setw(19) << name;
+    }
+    std::cout << std::endl;
+    std::cout << "Sample rate " << std::setprecision(3) << adaptive.sampleRate() << ", " << adaptive.switchCount()
+              << " switches, final estimates:";
+    for (const auto& estimate : adaptive.estimates()) {
+        std::cout << " " << estimate.first << " " << std::setprecision(2) << estimate.second * 100 << "%";
+    }
+    std::cout << std::endl;
+}
+
+// 磁盘二级缓存：内存LRU与LRU+磁盘层在同一Zipf访问下对比，每次未命中按对数正态延迟(中位数200us)估算数据库耗时。
+// 磁盘读取的延迟包括页缓存的影响，刚写入的段通常还在页缓存中
+void runTwoTierTest(const std::string& directory) {
+    const size_t CACHE_SIZE = 10000;
+    const size_t KEY_COUNT = 500000;
+    const size_t VALUE_SIZE = 512;
+    const uint64_t SEGMENT_BYTES = 16 << 20;
+    const size_t SEGMENTS = 16;
+    Workload workload = Workloads::zipf(KEY_COUNT, 2000000, 0.9, 51);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+    const std::string value_template(VALUE_SIZE, 'v');
+    LatencyModel backend = LatencyModel::logNormal(std::chrono::microseconds(200), 0.5);
+    std::mt19937 gen(7);
+
+    std::cout << "\n=== Two-Tier Cache (" << workload.name << ", " << KEY_COUNT << " keys, " << VALUE_SIZE
+              << "-byte values, memory " << CACHE_SIZE << " entries, disk " << SEGMENTS << " x "
+              << (SEGMENT_BYTES >> 20) << " MB) ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "Cache" << std::right << std::setw(11) << "Memory hit"
+              << std::setw(11) << "Disk hit" << std::setw(11) << "DB trips" << std::setw(14) << "ns/mem hit"
+              << std::setw(14) << "ns/disk hit" << std::setw(14) << "Est. DB (s)" << std::endl;
+
+    // 回放访问序列，按每次get的结果分类计时
+    auto run = [&](const std::string& name, auto& cache, auto disk_hits) {
+        LatencyHistogram memory_latency, disk_latency;
+        size_t db_trips = 0;
+        double db_seconds = 0;
+        std::string value;
+        for (int index : workload.indices) {
+            const std::string& key = keys[index];
+            size_t disk_before = disk_hits(cache);
+            auto start = std::chrono::steady_clock::now();
+            bool hit = cache.get(key, value);
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (disk_hits(cache) != disk_before) {
+                disk_latency.record(ns);
+            } else if (hit) {
+                memory_latency.record(ns);
+            }
+            if (!hit) {
+                db_trips++;
+                db_seconds += std::chrono::duration<double>(backend.sample(gen, 1)).count();
+                value = value_template;
+                value.replace(0, key.size(), key);
+                cache.put(key, value);
+            }
+        }
+        size_t ops = workload.indices.size();
+        std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << memory_latency.count() * 100.0 / ops << "%" << std::setw(10)
+                  << disk_latency.count() * 100.0 / ops << "%" << std::setw(11) << db_trips << std::setprecision(0)
+                  << std::setw(14) << memory_latency.mean() << std::setw(14) << disk_latency.mean()
+                  << std::setprecision(1) << std::setw(14) << db_seconds << std::endl;
+    };
+
+    {
+        LRUCache<std::string> cache(CACHE_SIZE);
+        run("LRU", cache, [](LRUCache<std::string>&) { return size_t(0); });
+    }
+    {
+        TwoTierCache<LRUCache<std::string>> cache(directory, SEGMENT_BYTES, SEGMENTS, CACHE_SIZE);
+        typedef TwoTierCache<LRUCache<std::string>> Tiered;
+        run("LRU+disk", cache, [](Tiered& c) { return c.diskHits(); });
+        DiskTier& disk = cache.diskTier();
+        std::cout << "Disk tier: " << disk.size() << " entries, " << std::setprecision(1)
+                  << disk.diskBytes() / (1024.0 * 1024.0) << " MB on disk, " << disk.bytesWritten() / (1024.0 * 1024.0)
+                  << " MB written, " << disk.diskReads() << " preads, " << disk.segmentsDropped()
+                  << " segments dropped" << std::endl;
+    }
+}
+
+// 快照保存、热启动和完整恢复，Zipf 0.9访问，缓存容量为键数的20%
+void runSnapshotTest(const std::string& directory) {
+    const size_t KEY_COUNT = 1000000;
+    const size_t CAPACITY = 200000;
+    std::vector<std::string> keys;
+    keys.reserve(KEY_COUNT);
+    for (size_t i = 0; i < KEY_COUNT; i++) {
+        keys.push_back("key_" + std::to_string(i));
+    }
+    Workload workload = Workloads::zipf(KEY_COUNT, 2000000, 0.9, 42);
+
+    std::cout << "\n=== Snapshot & Warm Restart (" << workload.name << ", " << KEY_COUNT << " keys, capacity "
+              << CAPACITY << ") ===" << std::endl;
+    std::cout << std::left << std::setw(8) << "Cache" << std::right << std::setw(10) << "Records" << std::setw(9)
+              << "MB" << std::setw(10) << "Save ms" << std::setw(10) << "Open ms" << std::setw(12) << "1st get us"
+              << std::setw(11) << "Cold hit" << std::setw(11) << "Warm hit" << std::setw(12) << "Restore ms"
+              << std::setw(11) << "Identical" << std::setw(11) << "Live kept" << std::endl;
+    const std::string path = directory + "/cache_test.snapshot";
+    CachePerformanceTest::testSnapshot<LRUCache<std::string>>("LRU", CAPACITY, workload, keys, path);
+    CachePerformanceTest::testSnapshot<LFUCache<std::string>>("LFU", CAPACITY, workload, keys, path);
+    CachePerformanceTest::testSnapshot<ARCCache<std::string>>("ARC", CAPACITY, workload, keys, path);
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    // 延迟测试可以输出JSON，不打印标题行
+    if (mode == "latency") {
+        runLatencyTest(std::vector<std::string>(argv + 2, argv + argc));
+        return 0;
+    }
     std::cout << "Cache System Implementation with MySQL Integration" << std::endl;
+
+    if (mode == "concurrent") {
+        runConcurrentTest();
+        return 0;
+    }
+    if (mode == "batch") {
+        runBatchTest();
+        return 0;
+    }
+    if (mode == "pool") {
+        runPoolTest();
+        return 0;
+    }
+    if (mode == "backend") {
+        runBackendTest();
+        return 0;
+    }
+    if (mode == "stats") {
+        runStatsTest();
+        return 0;
+    }
+    if (mode == "workload") {
+        runWorkloadTest();
+        return 0;
+    }
+    if (mode == "import") {
+        if (argc < 4) {
+            std::cerr << "usage: " << argv[0] << " import <keys.txt> <out.trace>" << std::endl;
+            return 1;
+        }
+        long long count = importTextTrace(argv[2], argv[3]);
+        if (count < 0) {
+            return 1;
+        }
+        std::cout << "Imported " << count << " requests into " << argv[3] << std::endl;
+        return 0;
+    }
+    if (mode == "replay") {
+        if (argc < 3) {
+            std::cerr << "usage: " << argv[0] << " replay <file.trace> [capacity]" << std::endl;
+            return 1;
+        }
+        runReplayTest(argv[2], argc > 3 ? std::stoul(argv[3]) : 10000);
+        return 0;
+    }
+    if (mode == "mrc") {
+        // 第一个参数为"-"时使用合成访问
+        std::string trace_path = argc > 2 && std::string(argv[2]) != "-" ? argv[2] : "";
+        runMissRatioCurveTest(trace_path, argc > 3 ? std::stoul(argv[3]) : 20000);
+        return 0;
+    }
+    if (mode == "tiered") {
+        // 段文件写在给定目录下(默认当前目录)，测试结束后删除
+        runTwoTierTest(argc > 2 ? argv[2] : ".");
+        return 0;
+    }
+    if (mode == "adaptive") {
+        runAdaptiveTest();
+        return 0;
+    }
+    if (mode == "compose") {
+        runCompositionTest();
+        return 0;
+    }
+    if (mode == "snapshot") {
+        // 快照文件写在给定目录下(默认当前目录)，测试结束后删除
+        runSnapshotTest(argc > 2 ? argv[2] : ".");
+        return 0;
+    }
     
     // 1. 测试各种缓存策略
     const size_t CACHE_SIZE = 100;
@@ -260,42 +1981,209 @@ int main() {
     LRUCache<std::string> lru_cache(CACHE_SIZE);
     LFUCache<std::string> lfu_cache(CACHE_SIZE);
     ARCCache<std::string> arc_cache(CACHE_SIZE);
+    ClockCache<std::string> clock_cache(CACHE_SIZE);
+    ClockProCache<std::string> clock_pro_cache(CACHE_SIZE);
     
     // 生成测试数据
     std::cout << "Generating test data..." << std::endl;
     std::vector<std::pair<std::string, std::string>> test_data = generateTestData(1000);
+    Workload workload = Workloads::hotCold(test_data.size(), TEST_ITERATIONS, 42);
     
     // 测试各种缓存策略
-    CachePerformanceTest::testCache(fifo_cache, "FIFO", test_data, TEST_ITERATIONS);
-    CachePerformanceTest::testCache(lru_cache, "LRU", test_data, TEST_ITERATIONS);
-    CachePerformanceTest::testCache(lfu_cache, "LFU", test_data, TEST_ITERATIONS);
-    CachePerformanceTest::testCache(arc_cache, "ARC", test_data, TEST_ITERATIONS);
-    
-    // 2. MySQL数据库连接测试
+    CachePerformanceTest::testCache(fifo_cache, "FIFO", test_data, workload);
+    CachePerformanceTest::testCache(lru_cache, "LRU", test_data, workload);
+    CachePerformanceTest::testCache(lfu_cache, "LFU", test_data, workload);
+    CachePerformanceTest::testCache(arc_cache, "ARC", test_data, workload);
+    CachePerformanceTest::testCache(clock_cache, "CLOCK", test_data, workload);
+    CachePerformanceTest::testCache(clock_pro_cache, "CLOCK-Pro", test_data, workload);
+
+    // LFU淘汰开销应与容量无关
+    CachePerformanceTest::testEvictionScaling<LFUCache<std::string>>("LFU", {1000, 10000, 100000, 1000000}, 10000);
+
+    // 每次操作的堆分配次数：std::list实现的LRU与节点池、slab记录实现的LRU对比
+    // 需要计数分配的测试只在-DALLOC_COUNTER_ENABLED=1的构建中运行
+    const char* alloc_counter_off = "Allocation counting compiled out (build with -DALLOC_COUNTER_ENABLED=1)";
+    std::cout << "\n=== Allocations per Operation ===" << std::endl;
+    if (AllocCounter::enabled()) {
+        std::cout << std::left << std::setw(12) << "Cache" << std::right << std::setw(12) << "Allocs/get"
+                  << std::setw(12) << "ns/get" << std::setw(12) << "Allocs/put" << std::setw(12) << "ns/put"
+                  << std::endl;
+        CachePerformanceTest::testAllocations<LRUCache<std::string>>("LRU", 10000, 100000);
+        CachePerformanceTest::testAllocations<PooledLRUCache<std::string>>("PooledLRU", 10000, 100000);
+        CachePerformanceTest::testAllocations<SlabLRUCache<std::string>>("SlabLRU", 10000, 100000);
+    } else {
+        std::cout << alloc_counter_off << std::endl;
+    }
+
+    // 缓存索引查找延迟：std::unordered_map与FlatHashMap对比
+    std::cout << "\n=== Index Lookup Latency ===" << std::endl;
+    std::cout << std::left << std::setw(16) << "Index" << std::right << std::setw(10) << "Entries"
+              << std::setw(12) << "ns/hit" << std::setw(12) << "ns/miss" << std::endl;
+    for (size_t entries : {1000, 100000, 1000000}) {
+        CachePerformanceTest::testIndexLookup<std::unordered_map<std::string, size_t>>("unordered_map", entries, 1000000);
+        CachePerformanceTest::testIndexLookup<FlatHashMap<std::string, size_t>>("FlatHashMap", entries, 1000000);
+    }
+
+    // ARC每个条目的内存占用
+    std::cout << "\n=== ARC Memory per Entry ===" << std::endl;
+    if (AllocCounter::enabled()) {
+        CachePerformanceTest::testARCMemory(10000, 16);
+        CachePerformanceTest::testARCMemory(10000, 1024);
+    } else {
+        std::cout << alloc_counter_off << std::endl;
+    }
+
+    // 各策略每个条目占用的字节数，SlabLRU把键、值和元数据放在一条slab记录中
+    std::cout << "\n=== Bytes per Entry (100000 entries, 21-byte keys) ===" << std::endl;
+    if (AllocCounter::enabled()) {
+        std::cout << std::left << std::setw(12) << "Cache" << std::right << std::setw(8) << "Value" << std::setw(12)
+                  << "Requested" << std::setw(10) << "Malloc" << std::setw(10) << "Blocks" << std::endl;
+        for (size_t value_size : {16, 100}) {
+            CachePerformanceTest::testMemoryPerEntry<FIFOCache<std::string>>("FIFO", 100000, value_size);
+            CachePerformanceTest::testMemoryPerEntry<LRUCache<std::string>>("LRU", 100000, value_size);
+            CachePerformanceTest::testMemoryPerEntry<LFUCache<std::string>>("LFU", 100000, value_size);
+            CachePerformanceTest::testMemoryPerEntry<ARCCache<std::string>>("ARC", 100000, value_size);
+            CachePerformanceTest::testMemoryPerEntry<PooledLRUCache<std::string>>("PooledLRU", 100000, value_size);
+            CachePerformanceTest::testMemoryPerEntry<SlabLRUCache<std::string>>("SlabLRU", 100000, value_size);
+        }
+    } else {
+        std::cout << alloc_counter_off << std::endl;
+    }
+
+    // 按字节预算限制容量：值大小在50B到200KB之间按对数均匀分布
+    {
+        const size_t KEY_COUNT = 4000;
+        const size_t BYTE_BUDGET = 16 * 1024 * 1024;
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> log_size(std::log(50.0), std::log(200.0 * 1024));
+        std::vector<size_t> value_sizes;
+        double mean_size = 0;
+        for (size_t i = 0; i < KEY_COUNT; i++) {
+            value_sizes.push_back(static_cast<size_t>(std::exp(log_size(gen))));
+            mean_size += value_sizes.back();
+        }
+        mean_size /= KEY_COUNT;
+        std::vector<int> trace = CachePerformanceTest::generateAccessPattern(KEY_COUNT, 100000, 7);
+        // 按条目数限制时，容量取预算除以平均值大小
+        size_t count_capacity = static_cast<size_t>(BYTE_BUDGET / mean_size);
+
+        std::cout << "\n=== Byte-Weighted Capacity (budget " << BYTE_BUDGET / (1024 * 1024) << " MB) ===" << std::endl;
+        std::cout << std::left << std::setw(16) << "Cache" << std::right << std::setw(10) << "Entries"
+                  << std::setw(14) << "Peak heap(MB)" << std::setw(11) << "Hit rate" << std::endl;
+        LRUCache<std::string> lru_by_count(count_capacity);
+        LRUCache<std::string, ByteWeigher> lru_by_bytes(BYTE_BUDGET);
+        FIFOCache<std::string, ByteWeigher> fifo_by_bytes(BYTE_BUDGET);
+        LFUCache<std::string, ByteWeigher> lfu_by_bytes(BYTE_BUDGET);
+        ARCCache<std::string, ByteWeigher> arc_by_bytes(BYTE_BUDGET);
+        CachePerformanceTest::testWeightedCapacity("LRU (entries)", lru_by_count, trace, value_sizes);
+        CachePerformanceTest::testWeightedCapacity("LRU (bytes)", lru_by_bytes, trace, value_sizes);
+        CachePerformanceTest::testWeightedCapacity("FIFO (bytes)", fifo_by_bytes, trace, value_sizes);
+        CachePerformanceTest::testWeightedCapacity("LFU (bytes)", lfu_by_bytes, trace, value_sizes);
+        CachePerformanceTest::testWeightedCapacity("ARC (bytes)", arc_by_bytes, trace, value_sizes);
+    }
+
+    // TTL过期：对比不带过期的LRU与带过期的LRU的命中延迟，并检查到期后的读取
+    {
+        const size_t TTL_ENTRIES = 10000;
+        const std::chrono::milliseconds TTL(500);
+        std::cout << "\n=== TTL Expiration (ttl " << TTL.count() << " ms) ===" << std::endl;
+        std::cout << std::left << std::setw(20) << "Cache" << std::right << std::setw(10) << "ns/get"
+                  << std::setw(11) << "Hit rate" << std::setw(14) << "Stale hits" << std::setw(10) << "Size" << std::endl;
+        LRUCache<std::string> plain_lru(TTL_ENTRIES);
+        ExpiringCache<LRUCache<std::string>> write_ttl_lru(TTL_ENTRIES, TTL);
+        ExpiringCache<LRUCache<std::string>> access_ttl_lru(TTL_ENTRIES, TTL, ExpirePolicy::AfterAccess);
+        ExpiringCache<ARCCache<std::string>> write_ttl_arc(TTL_ENTRIES, TTL);
+        CachePerformanceTest::testExpiration("LRU", plain_lru, TTL_ENTRIES, 1000000, TTL);
+        CachePerformanceTest::testExpiration("LRU+TTL (write)", write_ttl_lru, TTL_ENTRIES, 1000000, TTL);
+        CachePerformanceTest::testExpiration("LRU+TTL (access)", access_ttl_lru, TTL_ENTRIES, 1000000, TTL);
+        CachePerformanceTest::testExpiration("ARC+TTL (write)", write_ttl_arc, TTL_ENTRIES, 1000000, TTL);
+
+        // 写入远多于容量的键：定时器随条目一起被淘汰，索引大小不超过容量
+        for (size_t i = 0; i < 10 * TTL_ENTRIES; i++) {
+            write_ttl_lru.put("churn_key_" + std::to_string(i), "value");
+        }
+        std::cout << "Timers after writing " << 10 * TTL_ENTRIES << " keys: " << write_ttl_lru.timerCount()
+                  << " (capacity " << TTL_ENTRIES << ")" << std::endl;
+    }
+
+    // 延迟写
+    std::cout << "\n=== Write-Behind ===" << std::endl;
+    CachePerformanceTest::testWriteBehind(2000, 5000, std::chrono::microseconds(200));
+
+    // 大值命中延迟：拷贝get与句柄get对比
+    std::cout << "\n=== Large Value Hit Latency ===" << std::endl;
+    std::cout << std::left << std::setw(12) << "Cache" << std::right << std::setw(10) << "Bytes"
+              << std::setw(14) << "ns/copy get" << std::setw(14) << "ns/handle get" << std::endl;
+    for (size_t value_size : {64, 4096, 16384}) {
+        CachePerformanceTest::testValueAccess<FIFOCache<std::string>>("FIFO", 1000, value_size, 200000);
+        CachePerformanceTest::testValueAccess<LRUCache<std::string>>("LRU", 1000, value_size, 200000);
+        CachePerformanceTest::testValueAccess<LFUCache<std::string>>("LFU", 1000, value_size, 200000);
+        CachePerformanceTest::testValueAccess<ARCCache<std::string>>("ARC", 1000, value_size, 200000);
+    }
+
+    // 准入控制
+    runAdmissionTest();
+
+    // 各访问模式下的命中率
+    runWorkloadTest();
+
+    // 缓存自带的统计
+    runStatsTest();
+
+    // 2. MySQL数据库连接测试，连接失败时改用模拟延迟的内存后端
     std::cout << "\n=== MySQL Database Connection Test ===" << std::endl;
     MySQLDB db;
+    std::unique_ptr<InMemoryStore> memory_store;
+    BackingStore* store = &db;
     
     if (db.connect("localhost", "ikun", "1234", "cache_test")) {
         std::cout << "MySQL connection test passed!" << std::endl;
-        
-        // 3. 测试数据库访问的缓存策略
-        std::cout << "\n=== Database Cache Performance Test ===" << std::endl;
-        std::vector<std::string> test_keys = generateTestKeys(1000);
-        const int DB_TEST_ITERATIONS = 5000;
-        
-        // 为数据库测试重新创建缓存实例
-        FIFOCache<std::string> db_fifo_cache(CACHE_SIZE);
-        LRUCache<std::string> db_lru_cache(CACHE_SIZE);
-        LFUCache<std::string> db_lfu_cache(CACHE_SIZE);
-        ARCCache<std::string> db_arc_cache(CACHE_SIZE);
-        
-        // 测试各种缓存策略在数据库访问场景下的性能
-        CachePerformanceTest::testDatabaseCache(db_fifo_cache, "FIFO", db, test_keys, DB_TEST_ITERATIONS);
-        CachePerformanceTest::testDatabaseCache(db_lru_cache, "LRU", db, test_keys, DB_TEST_ITERATIONS);
-        CachePerformanceTest::testDatabaseCache(db_lfu_cache, "LFU", db, test_keys, DB_TEST_ITERATIONS);
-        CachePerformanceTest::testDatabaseCache(db_arc_cache, "ARC", db, test_keys, DB_TEST_ITERATIONS);
     } else {
-        std::cout << "MySQL connection test failed. Please check your MySQL configuration." << std::endl;
+        std::cout << "MySQL connection test failed, using in-memory store (lognormal latency, median 200 us)."
+                  << std::endl;
+        memory_store.reset(new InMemoryStore(LatencyModel::logNormal(std::chrono::microseconds(200), 0.5)));
+        store = memory_store.get();
+    }
+        
+    // 3. 测试数据库访问的缓存策略
+    std::cout << "\n=== Database Cache Performance Test ===" << std::endl;
+    std::vector<std::string> test_keys = generateTestKeys(1000);
+    const int DB_TEST_ITERATIONS = 5000;
+    
+    // 为数据库测试重新创建缓存实例
+    FIFOCache<std::string> db_fifo_cache(CACHE_SIZE);
+    LRUCache<std::string> db_lru_cache(CACHE_SIZE);
+    LFUCache<std::string> db_lfu_cache(CACHE_SIZE);
+    ARCCache<std::string> db_arc_cache(CACHE_SIZE);
+    // 数据库中的值可能被修改，缓存的值写入后60秒过期，避免一直读到旧数据
+    ExpiringCache<LRUCache<std::string>> db_ttl_lru_cache(CACHE_SIZE, std::chrono::seconds(60));
+    
+    // 测试各种缓存策略在数据库访问场景下的性能
+    CachePerformanceTest::testDatabaseCache(db_fifo_cache, "FIFO", *store, test_keys, DB_TEST_ITERATIONS);
+    CachePerformanceTest::testDatabaseCache(db_lru_cache, "LRU", *store, test_keys, DB_TEST_ITERATIONS);
+    CachePerformanceTest::testDatabaseCache(db_lfu_cache, "LFU", *store, test_keys, DB_TEST_ITERATIONS);
+    CachePerformanceTest::testDatabaseCache(db_arc_cache, "ARC", *store, test_keys, DB_TEST_ITERATIONS);
+    CachePerformanceTest::testDatabaseCache(db_ttl_lru_cache, "LRU+TTL", *store, test_keys, DB_TEST_ITERATIONS);
+
+    // 延迟写：MySQL时后台线程使用单独的连接(MYSQL连接不能被多个线程同时使用)，内存后端是线程安全的
+    MySQLDB flush_db;
+    BackingStore* flush_store = memory_store.get();
+    if (!memory_store && flush_db.connect("localhost", "ikun", "1234", "cache_test")) {
+        flush_store = &flush_db;
+    }
+    if (flush_store) {
+        WriteBehindBuffer<std::string> write_behind(
+            [flush_store](const WriteBehindBuffer<std::string>::Batch& rows) {
+                return flush_store->putDataBatch(rows);
+            },
+            100, std::chrono::milliseconds(50), 10000);
+        std::vector<std::string> fresh_keys;
+        for (const std::string& key : test_keys) {
+            fresh_keys.push_back("wb_" + key);
+        }
+        LRUCache<std::string> db_wb_lru_cache(CACHE_SIZE);
+        CachePerformanceTest::testDatabaseCache(db_wb_lru_cache, "LRU+WriteBehind", *store, fresh_keys,
+                                                DB_TEST_ITERATIONS, &write_behind);
     }
     
     std::cout << "\nCache system testing completed!" << std::endl;